@@ -0,0 +1,235 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include "search.hpp"
+#include "pgn.hpp"
+
+// Streams FEN lines or PGN games in, one JSON line per analysed position out, in input order
+namespace analyze
+{
+    struct Job{
+        uint64_t sequence = 0;
+        std::string id;
+        int ply = 0;
+        std::string played;             // Move played from this position in the game, if any
+        chess::GameHistory game;
+        Job() : game(chess::START_FEN){}
+    };
+
+    // Producer -> workers -> ordered writer. At most `window` positions are in flight,
+    // so memory stays bounded however large the input is.
+    struct Pipeline{
+        std::mutex mutex;
+        std::condition_variable jobReady, resultReady, slotFree;
+        std::deque<Job> jobs;
+        std::vector<std::string> slots;
+        std::vector<bool> filled;
+        uint64_t produced = 0, written = 0;
+        bool inputDone = false;
+
+        explicit Pipeline(size_t window) : slots(window), filled(window, false){}
+
+        void push(Job job){
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFree.wait(lock, [&]{ return produced - written < slots.size(); });
+            job.sequence = produced++;
+            jobs.push_back(std::move(job));
+            jobReady.notify_one();
+        }
+
+        bool pop(Job &job){
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [&]{ return !jobs.empty() || inputDone; });
+            if (jobs.empty()) { return false; }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            return true;
+        }
+
+        void finish(uint64_t sequence, std::string line){
+            std::lock_guard<std::mutex> lock(mutex);
+            slots[sequence % slots.size()] = std::move(line);
+            filled[sequence % slots.size()] = true;
+            resultReady.notify_one();
+        }
+
+        void close(){
+            std::lock_guard<std::mutex> lock(mutex);
+            inputDone = true;
+            jobReady.notify_all();
+            resultReady.notify_all();
+        }
+
+        // Next result in input order, false once everything has been written
+        bool next(std::string &line){
+            std::unique_lock<std::mutex> lock(mutex);
+            size_t slot = written % slots.size();
+            resultReady.wait(lock, [&]{ return filled[slot] || (inputDone && written == produced); });
+            if (!filled[slot]) { return false; }
+            line = std::move(slots[slot]);
+            filled[slot] = false;
+            written++;
+            slotFree.notify_one();
+            return true;
+        }
+    };
+
+    std::string jsonString(const std::string &text){
+        std::string res = "\"";
+        for (char ch : text) {
+            if (ch == '"' || ch == '\\') { res += '\\'; res += ch; }
+            else if ((unsigned char)ch < 0x20) { res += ' '; }
+            else { res += ch; }
+        }
+        return res + "\"";
+    }
+
+    std::string toJson(const Job &job, const chess::SearchResult &result){
+        std::string scoreType, scoreValue;
+        std::istringstream(chess::scoreToUci(result.score)) >> scoreType >> scoreValue;
+        std::string json = "{\"id\":" + jsonString(job.id)
+                         + ",\"ply\":" + std::to_string(job.ply)
+                         + ",\"fen\":" + jsonString(job.game.position.fen());
+        if (!job.played.empty()) { json += ",\"played\":" + jsonString(job.played); }
+        if (result.bestMove == bitboard::NULL_MOVE) { // Game over, nothing to search
+            return json + ",\"bestmove\":null,\"depth\":0,\"nodes\":0,\"pv\":[]}";
+        }
+        json += ",\"bestmove\":" + jsonString(bitboard::moveToUci(result.bestMove));
+        if (result.depth > 0) { // A search stopped during its first iteration has no score
+            json += ",\"score\":{" + jsonString(scoreType) + ":" + scoreValue + "}";
+        }
+        json += ",\"depth\":" + std::to_string(result.depth)
+              + ",\"nodes\":" + std::to_string(result.nodes)
+              + ",\"pv\":[";
+        for (size_t i = 0; i < result.pv.size(); i++) {
+            json += (i ? "," : "") + jsonString(bitboard::moveToUci(result.pv[i]));
+        }
+        return json + "]}";
+    }
+
+    // Every position of a game before each move played in it
+    void pushGame(Pipeline &pipeline, const std::string &text, uint64_t gameNumber){
+        chess::PgnGame pgnGame = chess::parsePgn(text);
+        chess::GameHistory game(pgnGame.startFen);
+        for (size_t ply = 0; ply < pgnGame.moves.size(); ply++) {
+            Job job;
+            job.id = "game " + std::to_string(gameNumber);
+            job.ply = (int)ply;
+            job.played = bitboard::moveToUci(pgnGame.moves[ply]);
+            job.game = game;
+            pipeline.push(std::move(job));
+            game.play(pgnGame.moves[ply]);
+        }
+    }
+
+    void produce(std::istream &in, Pipeline &pipeline){
+        std::string line, gameText;
+        uint64_t lineNumber = 0, gameNumber = 0;
+        bool inMovetext = false;
+        auto flushGame = [&]() {
+            if (gameText.find_first_not_of(" \t\r\n") != std::string::npos) {
+                try { pushGame(pipeline, gameText, ++gameNumber); }
+                catch (const std::exception &e) { std::cerr << e.what() << "\n"; }
+            }
+            gameText.clear();
+            inMovetext = false;
+        };
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+            std::string trimmed = line.substr(std::min(line.size(), line.find_first_not_of(" \t")));
+            if (trimmed.empty()) { continue; }
+            if (trimmed[0] != '[' && chess::isFenLine(trimmed)) {
+                flushGame();
+                Job job;
+                job.id = "line " + std::to_string(lineNumber);
+                try { job.game = chess::GameHistory(trimmed); }
+                catch (const std::exception &e) { std::cerr << e.what() << "\n"; continue; }
+                pipeline.push(std::move(job));
+                continue;
+            }
+            if (trimmed[0] == '[' && inMovetext) { flushGame(); } // Next game's tags
+            inMovetext |= trimmed[0] != '[';
+            gameText += line + "\n";
+        }
+        flushGame();
+        pipeline.close();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string fileName = "-";
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t hashMB = 64;
+    chess::SearchLimits limits;
+    limits.depth = 8;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--threads" && hasValue) { threadCount = std::max(1, std::stoi(argv[++i])); }
+        else if (option == "--depth" && hasValue) { limits.depth = std::stoi(argv[++i]); }
+        else if (option == "--nodes" && hasValue) { limits.nodes = std::stoull(argv[++i]); limits.depth = chess::MAX_PLY - 1; }
+        else if (option == "--time" && hasValue) { limits.seconds = std::stod(argv[++i]); limits.depth = chess::MAX_PLY - 1; }
+        else if (option == "--hash" && hasValue) { hashMB = std::stoul(argv[++i]); }
+        else if (option[0] != '-' || option == "-") { fileName = option; }
+        else {
+            std::cerr << "Usage: analyze [file|-] [--threads N] [--depth D] [--nodes N] [--time seconds] [--hash MB]\n";
+            return 1;
+        }
+    }
+
+    std::ifstream file;
+    if (fileName != "-") {
+        file.open(fileName);
+        if (!file) { std::cerr << "---> Cannot open " << fileName << "\n"; return 1; }
+    }
+    std::istream &in = fileName == "-" ? std::cin : file;
+
+    bitboard::initTables();
+    chess::tt.resize(hashMB); // Shared by every worker
+    analyze::Pipeline pipeline(4 * threadCount);
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t totalNodes = 0, positions = 0;
+    std::mutex nodesMutex;
+
+    std::thread producer(analyze::produce, std::ref(in), std::ref(pipeline));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([&]() {
+            chess::blindSearch search;      // Own killers and key stack, shared hash table
+            uint64_t nodes = 0;
+            for (analyze::Job job; pipeline.pop(job); ) {
+                chess::SearchResult result = search.search(job.game, limits);
+                nodes += result.nodes;
+                pipeline.finish(job.sequence, analyze::toJson(job, result));
+            }
+            std::lock_guard<std::mutex> lock(nodesMutex);
+            totalNodes += nodes;
+        });
+    }
+
+    for (std::string line; pipeline.next(line); positions++) {
+        std::cout << line << "\n";
+    }
+    std::cout.flush();
+    producer.join();
+    for (std::thread &worker : workers) { worker.join(); }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cerr << "Positions: " << positions << "\n"
+              << "Threads: " << threadCount << "\n"
+              << "Total Nodes: " << totalNodes << "\n"
+              << "Duration: " << seconds << " second\n"
+              << "Positions/second: " << positions / std::max(seconds, 1e-9) << "\n"
+              << "Nodes/second: " << (uint64_t)(totalNodes / std::max(seconds, 1e-9)) << "\n";
+    return 0;
+}
@@ -0,0 +1,830 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include "eval.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SLIDER_PEXT  // BMI2 backend compiled in, used only if the CPU has it
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+// Native board representation and pseudo-legal move generation.
+// Squares are numbered a1 = 0 ... h8 = 63, pieces use the encoding from eval.hpp.
+
+namespace bitboard{
+
+typedef uint64_t Bitboard;
+typedef uint16_t Move;
+
+#define SQ_BB(sq) (1ULL << (sq))
+#define RANK_OF(sq) ((sq) >> 3)
+#define FILE_OF(sq) ((sq) & 7)
+#define PIECE_TYPE(pc) ((pc) >> 1)
+#define MAKE_PIECE(type, color) (2*(type) + (color))
+
+enum Square{
+    A1 = 0, B1, C1, D1, E1, F1, G1, H1,
+    A8 = 56, B8, C8, D8, E8, F8, G8, H8
+};
+
+enum CastlingRight{
+    WHITE_OO  = 1,
+    WHITE_OOO = 2,
+    BLACK_OO  = 4,
+    BLACK_OOO = 8
+};
+
+/* move encoding: from (6 bits) | to (6 bits) | flag (4 bits) */
+enum MoveFlag{
+    QUIET_MOVE      = 0,
+    DOUBLE_PUSH     = 1,
+    KING_CASTLE     = 2,
+    QUEEN_CASTLE    = 3,
+    CAPTURE         = 4,
+    EP_CAPTURE      = 5,
+    PROMOTION       = 8,   // + (promoted piece - KNIGHT)
+    PROMO_CAPTURE   = 12   // + (promoted piece - KNIGHT)
+};
+
+const Move NULL_MOVE = 0;
+const int MAX_MOVES = 256;
+
+inline Move encodeMove(int from, int to, int flag){ return Move(from | (to << 6) | (flag << 12)); }
+inline int moveFrom(Move m){ return m & 63; }
+inline int moveTo(Move m){ return (m >> 6) & 63; }
+inline int moveFlag(Move m){ return m >> 12; }
+inline bool isCapture(Move m){ return moveFlag(m) & 4; }
+inline bool isPromotion(Move m){ return moveFlag(m) & 8; }
+inline int promotionType(Move m){ return (moveFlag(m) & 3) + KNIGHT; }
+inline bool isQuiet(Move m){ return !isCapture(m) && !isPromotion(m); }
+
+inline int popLsb(Bitboard &b){
+    int sq = __builtin_ctzll(b);
+    b &= b - 1;
+    return sq;
+}
+
+inline int popCount(Bitboard b){ return __builtin_popcountll(b); }
+
+/* attack tables */
+Bitboard knightAttacks[64];
+Bitboard kingAttacks[64];
+Bitboard pawnAttacks[2][64];
+int castlingMask[64];
+
+/* zobrist keys */
+uint64_t zobristPieces[12][64];
+uint64_t zobristCastling[16];
+uint64_t zobristEnPassant[8];
+uint64_t zobristSide;
+
+std::atomic<bool> isInitialized{false};
+std::once_flag initOnce;
+
+uint64_t splitMix64(uint64_t &state){
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+Bitboard stepAttacks(int sq, const int (*steps)[2], int stepCount){
+    Bitboard attacks = 0;
+    for (int i = 0; i < stepCount; i++) {
+        int r = RANK_OF(sq) + steps[i][0];
+        int f = FILE_OF(sq) + steps[i][1];
+        if (r >= 0 && r < 8 && f >= 0 && f < 8) {
+            attacks |= SQ_BB(r * 8 + f);
+        }
+    }
+    return attacks;
+}
+
+// Walks each ray until the first blocker (included)
+Bitboard slidingAttacks(int sq, Bitboard occupied, const int (*directions)[2]){
+    Bitboard attacks = 0;
+    for (int i = 0; i < 4; i++) {
+        int r = RANK_OF(sq) + directions[i][0];
+        int f = FILE_OF(sq) + directions[i][1];
+        while (r >= 0 && r < 8 && f >= 0 && f < 8) {
+            attacks |= SQ_BB(r * 8 + f);
+            if (occupied & SQ_BB(r * 8 + f)) { break; }
+            r += directions[i][0];
+            f += directions[i][1];
+        }
+    }
+    return attacks;
+}
+
+const int bishopDirections[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+const int rookDirections[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+
+/* sliding piece attacks: ray loops (reference), fancy magic bitboards, BMI2 PEXT */
+
+enum class SliderBackend{
+    CLASSICAL,
+    MAGIC,
+    PEXT
+};
+
+SliderBackend sliderBackend = SliderBackend::CLASSICAL; // Picked by initTables()
+
+const char* sliderBackendName(SliderBackend backend){
+    switch (backend) {
+        case SliderBackend::MAGIC: return "magic";
+        case SliderBackend::PEXT:  return "pext";
+        default:                   return "classical";
+    }
+}
+
+struct Magic{
+    Bitboard mask;              // Relevant occupancy, board edges excluded
+    Bitboard magic;
+    Bitboard *attacks;          // Indexed by the magic multiply
+    Bitboard *pextAttacks;      // Indexed by pext(occupied, mask)
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const{ return unsigned(((occupied & mask) * magic) >> shift); }
+};
+
+Magic bishopMagics[64];
+Magic rookMagics[64];
+Bitboard bishopTable[5248];
+Bitboard rookTable[102400];
+Bitboard bishopPextTable[5248];
+Bitboard rookPextTable[102400];
+
+inline Bitboard bishopAttacksClassical(int sq, Bitboard occupied){ return slidingAttacks(sq, occupied, bishopDirections); }
+inline Bitboard rookAttacksClassical(int sq, Bitboard occupied){ return slidingAttacks(sq, occupied, rookDirections); }
+
+inline Bitboard bishopAttacksMagic(int sq, Bitboard occupied){
+    const Magic &m = bishopMagics[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard rookAttacksMagic(int sq, Bitboard occupied){
+    const Magic &m = rookMagics[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+#ifdef SLIDER_PEXT
+__attribute__((target("bmi2"))) inline Bitboard bishopAttacksPext(int sq, Bitboard occupied){
+    const Magic &m = bishopMagics[sq];
+    return m.pextAttacks[_pext_u64(occupied, m.mask)];
+}
+
+__attribute__((target("bmi2"))) inline Bitboard rookAttacksPext(int sq, Bitboard occupied){
+    const Magic &m = rookMagics[sq];
+    return m.pextAttacks[_pext_u64(occupied, m.mask)];
+}
+#else
+inline Bitboard bishopAttacksPext(int sq, Bitboard occupied){ return bishopAttacksMagic(sq, occupied); }
+inline Bitboard rookAttacksPext(int sq, Bitboard occupied){ return rookAttacksMagic(sq, occupied); }
+#endif
+
+bool cpuHasPext(){
+#ifdef SLIDER_PEXT
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+// AMD before Zen 3 implements PEXT in microcode, much slower than a magic multiply
+bool cpuHasFastPext(){
+#ifdef SLIDER_PEXT
+    if (!cpuHasPext()) { return false; }
+    if (__builtin_cpu_is("amd")) {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) { return false; }
+        unsigned family = ((eax >> 8) & 0xF) + ((eax >> 20) & 0xFF);
+        return family >= 0x19;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline Bitboard bishopAttacks(int sq, Bitboard occupied){
+    switch (sliderBackend) {
+        case SliderBackend::PEXT:  return bishopAttacksPext(sq, occupied);
+        case SliderBackend::MAGIC: return bishopAttacksMagic(sq, occupied);
+        default:                   return bishopAttacksClassical(sq, occupied);
+    }
+}
+
+inline Bitboard rookAttacks(int sq, Bitboard occupied){
+    switch (sliderBackend) {
+        case SliderBackend::PEXT:  return rookAttacksPext(sq, occupied);
+        case SliderBackend::MAGIC: return rookAttacksMagic(sq, occupied);
+        default:                   return rookAttacksClassical(sq, occupied);
+    }
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occupied){ return bishopAttacks(sq, occupied) | rookAttacks(sq, occupied); }
+
+Bitboard pieceAttacks(int type, int sq, Bitboard occupied){
+    switch (type) {
+        case KNIGHT: return knightAttacks[sq];
+        case BISHOP: return bishopAttacks(sq, occupied);
+        case ROOK:   return rookAttacks(sq, occupied);
+        case QUEEN:  return queenAttacks(sq, occupied);
+        case KING:   return kingAttacks[sq];
+    }
+    return 0;
+}
+
+// Fills both lookup tables of one slider and searches a magic for every square
+void initSliderTables(Magic *magics, Bitboard *table, Bitboard *pextTable, const int (*directions)[2], uint64_t &seed){
+    const Bitboard rankEdges = 0xFF000000000000FFULL, fileEdges = 0x8181818181818181ULL;
+    Bitboard occupancy[4096], reference[4096];
+    int epoch[4096] = {}, attempt = 0;
+    size_t offset = 0;
+
+    for (int sq = 0; sq < 64; sq++) {
+        Magic &m = magics[sq];
+        Bitboard edges = (rankEdges & ~(0xFFULL << (8 * RANK_OF(sq)))) | (fileEdges & ~(0x0101010101010101ULL << FILE_OF(sq)));
+        m.mask = slidingAttacks(sq, 0, directions) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = table + offset;
+        m.pextAttacks = pextTable + offset;
+
+        // Carry-Rippler walks the subsets of the mask in pext index order
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = slidingAttacks(sq, b, directions);
+            m.pextAttacks[size] = reference[size];
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+        offset += size;
+
+        for (int i = 0; i < size; ) {
+            for (m.magic = 0; popCount((m.magic * m.mask) >> 56) < 6; ) {
+                m.magic = splitMix64(seed) & splitMix64(seed) & splitMix64(seed);
+            }
+            // Collisions are fine only when both occupancies give the same attacks
+            for (++attempt, i = 0; i < size; i++) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                }
+                else if (m.attacks[idx] != reference[i]) { break; }
+            }
+        }
+    }
+}
+
+void buildTables(){
+    if (!eval::isInitialized) { eval::init_tables(); }
+    const int knightSteps[8][2] = { {2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2} };
+    const int kingSteps[8][2] = { {1, 1}, {1, 0}, {1, -1}, {0, 1}, {0, -1}, {-1, 1}, {-1, 0}, {-1, -1} };
+    const int whitePawnSteps[2][2] = { {1, 1}, {1, -1} };
+    const int blackPawnSteps[2][2] = { {-1, 1}, {-1, -1} };
+
+    for (int sq = 0; sq < 64; sq++) {
+        knightAttacks[sq] = stepAttacks(sq, knightSteps, 8);
+        kingAttacks[sq] = stepAttacks(sq, kingSteps, 8);
+        pawnAttacks[WHITE][sq] = stepAttacks(sq, whitePawnSteps, 2);
+        pawnAttacks[BLACK][sq] = stepAttacks(sq, blackPawnSteps, 2);
+        castlingMask[sq] = 15;
+    }
+    castlingMask[E1] &= ~(WHITE_OO | WHITE_OOO);
+    castlingMask[H1] &= ~WHITE_OO;
+    castlingMask[A1] &= ~WHITE_OOO;
+    castlingMask[E8] &= ~(BLACK_OO | BLACK_OOO);
+    castlingMask[H8] &= ~BLACK_OO;
+    castlingMask[A8] &= ~BLACK_OOO;
+
+    uint64_t seed = 0x5EED1E55ULL;
+    for (int pc = 0; pc < 12; pc++) {
+        for (int sq = 0; sq < 64; sq++) { zobristPieces[pc][sq] = splitMix64(seed); }
+    }
+    for (int i = 0; i < 16; i++) { zobristCastling[i] = splitMix64(seed); }
+    for (int i = 0; i < 8; i++) { zobristEnPassant[i] = splitMix64(seed); }
+    zobristSide = splitMix64(seed);
+
+    uint64_t magicSeed = 0x3A61C5ULL;
+    initSliderTables(bishopMagics, bishopTable, bishopPextTable, bishopDirections, magicSeed);
+    initSliderTables(rookMagics, rookTable, rookPextTable, rookDirections, magicSeed);
+    sliderBackend = cpuHasFastPext() ? SliderBackend::PEXT : SliderBackend::MAGIC;
+
+    isInitialized = true;
+}
+
+// Any thread may call this; the first call builds the tables while the others wait for it
+void initTables(){
+    std::call_once(initOnce, buildTables);
+}
+
+std::string squareToString(int sq){
+    return std::string(1, char('a' + FILE_OF(sq))) + char('1' + RANK_OF(sq));
+}
+
+std::string moveToUci(Move m){
+    if (m == NULL_MOVE) { return "NULL"; }
+    std::string uci = squareToString(moveFrom(m)) + squareToString(moveTo(m));
+    if (isPromotion(m)) { uci += "nbrq"[promotionType(m) - KNIGHT]; }
+    return uci;
+}
+
+struct Position{
+    Bitboard pieces[12];
+    Bitboard colors[2];
+    Bitboard occupied;
+    int squares[64];
+
+    int side;
+    int castling;
+    int epSquare;
+    int halfmoveClock;
+    int fullmoveNumber;
+    uint64_t key;
+
+    Position(){ clear(); }
+
+    explicit Position(const std::string &fen){ setFen(fen); }
+
+    void clear(){
+        if (!isInitialized) { initTables(); }
+        std::fill(pieces, pieces + 12, 0);
+        std::fill(squares, squares + 64, EMPTY);
+        colors[WHITE] = colors[BLACK] = occupied = 0;
+        side = WHITE;
+        castling = 0;
+        epSquare = -1;
+        halfmoveClock = 0;
+        fullmoveNumber = 1;
+        key = 0;
+    }
+
+    void putPiece(int pc, int sq){
+        pieces[pc] |= SQ_BB(sq);
+        colors[PCOLOR(pc)] |= SQ_BB(sq);
+        occupied |= SQ_BB(sq);
+        squares[sq] = pc;
+        key ^= zobristPieces[pc][sq];
+    }
+
+    void removePiece(int sq){
+        int pc = squares[sq];
+        pieces[pc] &= ~SQ_BB(sq);
+        colors[PCOLOR(pc)] &= ~SQ_BB(sq);
+        occupied &= ~SQ_BB(sq);
+        squares[sq] = EMPTY;
+        key ^= zobristPieces[pc][sq];
+    }
+
+    void movePiece(int from, int to){
+        int pc = squares[from];
+        removePiece(from);
+        putPiece(pc, to);
+    }
+
+    void setFen(const std::string &fen){
+        clear();
+        std::istringstream ss(fen);
+        std::string placement, stm, rights, ep;
+        ss >> placement >> stm >> rights >> ep;
+        if (placement.empty()) { throw std::runtime_error("---> Invalid FEN: " + fen); }
+
+        int rank = 7, file = 0;
+        for (char ch : placement) {
+            if (ch == '/') { rank--; file = 0; }
+            else if (isdigit(ch)) { file += ch - '0'; }
+            else {
+                auto it = eval::pieceMap.find(ch);
+                if (it == eval::pieceMap.end() || rank < 0 || file > 7) {
+                    throw std::runtime_error("---> Invalid FEN: " + fen);
+                }
+                putPiece(it->second, rank * 8 + file);
+                file++;
+            }
+        }
+        // The search and check detection rely on exactly one king per side
+        if (popCount(pieces[MAKE_PIECE(KING, WHITE)]) != 1 || popCount(pieces[MAKE_PIECE(KING, BLACK)]) != 1) {
+            throw std::runtime_error("---> Invalid FEN, needs one king per side: " + fen);
+        }
+        // Pawn pushes index past the board from the first and last ranks
+        if ((pieces[WHITE_PAWN] | pieces[BLACK_PAWN]) & 0xFF000000000000FFULL) {
+            throw std::runtime_error("---> Invalid FEN, pawn on the first or last rank: " + fen);
+        }
+
+        side = (stm == "b") ? BLACK : WHITE;
+        for (char ch : rights) {
+            if (ch == 'K') { castling |= WHITE_OO; }
+            else if (ch == 'Q') { castling |= WHITE_OOO; }
+            else if (ch == 'k') { castling |= BLACK_OO; }
+            else if (ch == 'q') { castling |= BLACK_OOO; }
+        }
+        if (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] >= '1' && ep[1] <= '8') {
+            setEnPassant((ep[1] - '1') * 8 + (ep[0] - 'a'));
+        }
+        if (!(ss >> halfmoveClock)) { halfmoveClock = 0; }
+        if (!(ss >> fullmoveNumber)) { fullmoveNumber = 1; }
+
+        key ^= zobristCastling[castling];
+        if (side == BLACK) { key ^= zobristSide; }
+    }
+
+    std::string fen() const{
+        std::string res;
+        for (int rank = 7; rank >= 0; rank--) {
+            int emptyCount = 0;
+            for (int file = 0; file < 8; file++) {
+                int pc = squares[rank * 8 + file];
+                if (pc == EMPTY) { emptyCount++; continue; }
+                if (emptyCount) { res += char('0' + emptyCount); emptyCount = 0; }
+                res += "PpNnBbRrQqKk"[pc];
+            }
+            if (emptyCount) { res += char('0' + emptyCount); }
+            if (rank) { res += '/'; }
+        }
+        res += side == WHITE ? " w " : " b ";
+        if (castling & WHITE_OO) { res += 'K'; }
+        if (castling & WHITE_OOO) { res += 'Q'; }
+        if (castling & BLACK_OO) { res += 'k'; }
+        if (castling & BLACK_OOO) { res += 'q'; }
+        if (!castling) { res += '-'; }
+        res += " " + (epSquare == -1 ? std::string("-") : squareToString(epSquare));
+        res += " " + std::to_string(halfmoveClock) + " " + std::to_string(fullmoveNumber);
+        return res;
+    }
+
+    // The en passant square is only recorded when a capture is possible,
+    // so that transpositions hash (and repeat) identically.
+    void setEnPassant(int sq){
+        if (side == WHITE) { setEnPassantFor<WHITE>(sq); }
+        else { setEnPassantFor<BLACK>(sq); }
+    }
+
+    template<int Us>
+    void setEnPassantFor(int sq){
+        if (pawnAttacks[OTHER(Us)][sq] & pieces[MAKE_PIECE(PAWN, Us)]) {
+            epSquare = sq;
+            key ^= zobristEnPassant[FILE_OF(sq)];
+        }
+    }
+
+    int kingSquare(int color) const{ return __builtin_ctzll(pieces[MAKE_PIECE(KING, color)]); }
+
+    // Hot paths below come in a version per color (Us, Them are compile-time constants)
+    // behind a runtime dispatch on the side to move
+    template<int By>
+    bool isSquareAttackedBy(int sq) const{
+        if (pawnAttacks[OTHER(By)][sq] & pieces[MAKE_PIECE(PAWN, By)]) { return true; }
+        if (knightAttacks[sq] & pieces[MAKE_PIECE(KNIGHT, By)]) { return true; }
+        if (kingAttacks[sq] & pieces[MAKE_PIECE(KING, By)]) { return true; }
+        Bitboard queens = pieces[MAKE_PIECE(QUEEN, By)];
+        if (bishopAttacks(sq, occupied) & (pieces[MAKE_PIECE(BISHOP, By)] | queens)) { return true; }
+        if (rookAttacks(sq, occupied) & (pieces[MAKE_PIECE(ROOK, By)] | queens)) { return true; }
+        return false;
+    }
+
+    bool isSquareAttacked(int sq, int bySide) const{
+        return bySide == WHITE ? isSquareAttackedBy<WHITE>(sq) : isSquareAttackedBy<BLACK>(sq);
+    }
+
+    template<int Us>
+    bool inCheckFor() const{ return isSquareAttackedBy<OTHER(Us)>(kingSquare(Us)); }
+
+    bool inCheck() const{ return side == WHITE ? inCheckFor<WHITE>() : inCheckFor<BLACK>(); }
+
+    // True if the side that just moved did not leave its own king attacked
+    bool wasLegal() const{ return side == WHITE ? !inCheckFor<BLACK>() : !inCheckFor<WHITE>(); }
+
+    void makeMove(Move m){
+        if (side == WHITE) { makeMoveFor<WHITE>(m); }
+        else { makeMoveFor<BLACK>(m); }
+    }
+
+    template<int Us>
+    void makeMoveFor(Move m){
+        constexpr int us = Us;
+        int from = moveFrom(m), to = moveTo(m), flag = moveFlag(m);
+        int pc = squares[from];
+
+        if (epSquare != -1) {
+            key ^= zobristEnPassant[FILE_OF(epSquare)];
+            epSquare = -1;
+        }
+        halfmoveClock++;
+
+        if (flag == EP_CAPTURE) { removePiece(to ^ 8); }
+        else if (isCapture(m)) { removePiece(to); }
+        if (isCapture(m) || PIECE_TYPE(pc) == PAWN) { halfmoveClock = 0; }
+
+        movePiece(from, to);
+        if (isPromotion(m)) {
+            removePiece(to);
+            putPiece(MAKE_PIECE(promotionType(m), us), to);
+        }
+        else if (flag == KING_CASTLE) { movePiece(to + 1, to - 1); }
+        else if (flag == QUEEN_CASTLE) { movePiece(to - 2, to + 1); }
+
+        key ^= zobristCastling[castling];
+        castling &= castlingMask[from] & castlingMask[to];
+        key ^= zobristCastling[castling];
+
+        if (us == BLACK) { fullmoveNumber++; }
+        side = OTHER(us);
+        key ^= zobristSide;
+
+        if (flag == DOUBLE_PUSH) { setEnPassantFor<OTHER(Us)>((from + to) / 2); }
+    }
+
+    // Passes the turn, used by null-move pruning
+    void makeNullMove(){
+        if (epSquare != -1) {
+            key ^= zobristEnPassant[FILE_OF(epSquare)];
+            epSquare = -1;
+        }
+        halfmoveClock++;
+        side = OTHER(side);
+        key ^= zobristSide;
+    }
+
+    // Anything besides pawns and king; without it null-move pruning is unsafe (zugzwang)
+    bool hasNonPawnMaterial(int color) const{
+        return colors[color] & ~(pieces[MAKE_PIECE(PAWN, color)] | pieces[MAKE_PIECE(KING, color)]);
+    }
+
+    bool canCastle(int right) const{
+        switch (right) {
+            case WHITE_OO:
+                return (castling & WHITE_OO) && squares[H1] == WHITE_ROOK && !(occupied & (SQ_BB(F1) | SQ_BB(G1)))
+                    && !isSquareAttacked(E1, BLACK) && !isSquareAttacked(F1, BLACK) && !isSquareAttacked(G1, BLACK);
+            case WHITE_OOO:
+                return (castling & WHITE_OOO) && squares[A1] == WHITE_ROOK && !(occupied & (SQ_BB(B1) | SQ_BB(C1) | SQ_BB(D1)))
+                    && !isSquareAttacked(E1, BLACK) && !isSquareAttacked(D1, BLACK) && !isSquareAttacked(C1, BLACK);
+            case BLACK_OO:
+                return (castling & BLACK_OO) && squares[H8] == BLACK_ROOK && !(occupied & (SQ_BB(F8) | SQ_BB(G8)))
+                    && !isSquareAttacked(E8, WHITE) && !isSquareAttacked(F8, WHITE) && !isSquareAttacked(G8, WHITE);
+            case BLACK_OOO:
+                return (castling & BLACK_OOO) && squares[A8] == BLACK_ROOK && !(occupied & (SQ_BB(B8) | SQ_BB(C8) | SQ_BB(D8)))
+                    && !isSquareAttacked(E8, WHITE) && !isSquareAttacked(D8, WHITE) && !isSquareAttacked(C8, WHITE);
+        }
+        return false;
+    }
+
+    static int addPromotions(Move *list, int count, int from, int to, int baseFlag){
+        for (int type = QUEEN; type >= KNIGHT; type--) {
+            list[count++] = encodeMove(from, to, baseFlag + type - KNIGHT);
+        }
+        return count;
+    }
+
+    // Captures and promotions
+    int generateCaptures(Move *list) const{
+        return side == WHITE ? generateCapturesFor<WHITE>(list) : generateCapturesFor<BLACK>(list);
+    }
+
+    template<int Us>
+    int generateCapturesFor(Move *list) const{
+        constexpr int us = Us, them = OTHER(Us);
+        constexpr int promoRank = us == WHITE ? 6 : 1;
+        constexpr int forward = us == WHITE ? 8 : -8;
+        int count = 0;
+        Bitboard enemies = colors[them];
+
+        Bitboard pawns = pieces[MAKE_PIECE(PAWN, us)];
+        while (pawns) {
+            int from = popLsb(pawns);
+            bool promotes = RANK_OF(from) == promoRank;
+            Bitboard targets = pawnAttacks[us][from] & enemies;
+            while (targets) {
+                int to = popLsb(targets);
+                if (promotes) { count = addPromotions(list, count, from, to, PROMO_CAPTURE); }
+                else { list[count++] = encodeMove(from, to, CAPTURE); }
+            }
+            if (promotes && squares[from + forward] == EMPTY) {
+                count = addPromotions(list, count, from, from + forward, PROMOTION);
+            }
+        }
+        if (epSquare != -1) {
+            Bitboard attackers = pawnAttacks[them][epSquare] & pieces[MAKE_PIECE(PAWN, us)];
+            while (attackers) { list[count++] = encodeMove(popLsb(attackers), epSquare, EP_CAPTURE); }
+        }
+
+        for (int type = KNIGHT; type <= KING; type++) {
+            Bitboard pcs = pieces[MAKE_PIECE(type, us)];
+            while (pcs) {
+                int from = popLsb(pcs);
+                Bitboard targets = pieceAttacks(type, from, occupied) & enemies;
+                while (targets) { list[count++] = encodeMove(from, popLsb(targets), CAPTURE); }
+            }
+        }
+        return count;
+    }
+
+    // Non-capturing, non-promoting moves including castling
+    int generateQuiets(Move *list) const{
+        return side == WHITE ? generateQuietsFor<WHITE>(list) : generateQuietsFor<BLACK>(list);
+    }
+
+    template<int Us>
+    int generateQuietsFor(Move *list) const{
+        constexpr int us = Us;
+        constexpr int promoRank = us == WHITE ? 6 : 1;
+        constexpr int startRank = us == WHITE ? 1 : 6;
+        constexpr int forward = us == WHITE ? 8 : -8;
+        constexpr int kingFrom = us == WHITE ? E1 : E8;
+        constexpr int kingSide = us == WHITE ? WHITE_OO : BLACK_OO;
+        constexpr int queenSide = us == WHITE ? WHITE_OOO : BLACK_OOO;
+        int count = 0;
+        Bitboard empty = ~occupied;
+
+        Bitboard pawns = pieces[MAKE_PIECE(PAWN, us)];
+        while (pawns) {
+            int from = popLsb(pawns);
+            if (RANK_OF(from) == promoRank || squares[from + forward] != EMPTY) { continue; }
+            list[count++] = encodeMove(from, from + forward, QUIET_MOVE);
+            if (RANK_OF(from) == startRank && squares[from + 2 * forward] == EMPTY) {
+                list[count++] = encodeMove(from, from + 2 * forward, DOUBLE_PUSH);
+            }
+        }
+
+        for (int type = KNIGHT; type <= KING; type++) {
+            Bitboard pcs = pieces[MAKE_PIECE(type, us)];
+            while (pcs) {
+                int from = popLsb(pcs);
+                Bitboard targets = pieceAttacks(type, from, occupied) & empty;
+                while (targets) { list[count++] = encodeMove(from, popLsb(targets), QUIET_MOVE); }
+            }
+        }
+
+        if ((castling & kingSide) && canCastle(kingSide)) { list[count++] = encodeMove(kingFrom, kingFrom + 2, KING_CASTLE); }
+        if ((castling & queenSide) && canCastle(queenSide)) { list[count++] = encodeMove(kingFrom, kingFrom - 2, QUEEN_CASTLE); }
+        return count;
+    }
+
+    // Validates a move that did not come from the generator (hash move, killer)
+    bool isPseudoLegal(Move m) const{
+        if (m == NULL_MOVE) { return false; }
+        int us = side;
+        int from = moveFrom(m), to = moveTo(m), flag = moveFlag(m);
+        int pc = squares[from];
+        if (pc == EMPTY || PCOLOR(pc) != us || (colors[us] & SQ_BB(to))) { return false; }
+
+        if (flag == EP_CAPTURE) {
+            return PIECE_TYPE(pc) == PAWN && to == epSquare && (pawnAttacks[us][from] & SQ_BB(to));
+        }
+        if (isCapture(m) != (squares[to] != EMPTY)) { return false; }
+
+        if (flag == KING_CASTLE || flag == QUEEN_CASTLE) {
+            int right = us == WHITE ? (flag == KING_CASTLE ? WHITE_OO : WHITE_OOO)
+                                    : (flag == KING_CASTLE ? BLACK_OO : BLACK_OOO);
+            int kingFrom = us == WHITE ? E1 : E8;
+            int kingTo = kingFrom + (flag == KING_CASTLE ? 2 : -2);
+            return pc == MAKE_PIECE(KING, us) && from == kingFrom && to == kingTo && canCastle(right);
+        }
+
+        if (PIECE_TYPE(pc) == PAWN) {
+            int forward = us == WHITE ? 8 : -8;
+            bool lastRank = RANK_OF(to) == (us == WHITE ? 7 : 0);
+            if (lastRank != isPromotion(m)) { return false; }
+            if (isCapture(m)) { return pawnAttacks[us][from] & SQ_BB(to); }
+            if (flag == DOUBLE_PUSH) {
+                return RANK_OF(from) == (us == WHITE ? 1 : 6) && to == from + 2 * forward
+                    && squares[from + forward] == EMPTY && squares[to] == EMPTY;
+            }
+            return to == from + forward;
+        }
+
+        if (flag != QUIET_MOVE && flag != CAPTURE) { return false; }
+        return pieceAttacks(PIECE_TYPE(pc), from, occupied) & SQ_BB(to);
+    }
+
+    bool hasLegalMove() const{
+        Move list[MAX_MOVES];
+        int count = generateCaptures(list);
+        count += generateQuiets(list + count);
+        for (int i = 0; i < count; i++) {
+            Position next = *this;
+            next.makeMove(list[i]);
+            if (next.wasLegal()) { return true; }
+        }
+        return false;
+    }
+
+    // Bare kings, a single minor piece, or only bishops all on one square color
+    bool isInsufficientMaterial() const{
+        Bitboard heavy = pieces[WHITE_PAWN] | pieces[BLACK_PAWN] | pieces[WHITE_ROOK] | pieces[BLACK_ROOK]
+                       | pieces[WHITE_QUEEN] | pieces[BLACK_QUEEN];
+        if (heavy) { return false; }
+        Bitboard knights = pieces[WHITE_KNIGHT] | pieces[BLACK_KNIGHT];
+        Bitboard bishops = pieces[WHITE_BISHOP] | pieces[BLACK_BISHOP];
+        if (popCount(knights | bishops) <= 1) { return true; }
+        const Bitboard darkSquares = 0xAA55AA55AA55AA55ULL;
+        return !knights && (!(bishops & darkSquares) || !(bishops & ~darkSquares));
+    }
+
+    // Finds the generated move matching a UCI string, NULL_MOVE if none
+    Move parseUciMove(const std::string &uci) const{
+        Move list[MAX_MOVES];
+        int count = generateCaptures(list);
+        count += generateQuiets(list + count);
+        for (int i = 0; i < count; i++) {
+            if (moveToUci(list[i]) == uci) {
+                Position next = *this;
+                next.makeMove(list[i]);
+                if (next.wasLegal()) { return list[i]; }
+            }
+        }
+        return NULL_MOVE;
+    }
+
+    // Standard algebraic notation without the check suffix, the move must be legal
+    std::string moveToSan(Move m) const{
+        int from = moveFrom(m), to = moveTo(m), type = PIECE_TYPE(squares[from]);
+        if (moveFlag(m) == KING_CASTLE) { return "O-O"; }
+        if (moveFlag(m) == QUEEN_CASTLE) { return "O-O-O"; }
+        std::string san;
+        if (type == PAWN) {
+            if (isCapture(m)) { san += char('a' + FILE_OF(from)); }
+        }
+        else {
+            san += "NBRQK"[type - KNIGHT];
+            // Disambiguate against other legal moves of the same piece type to the same square
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            Move list[MAX_MOVES];
+            int count = generateCaptures(list);
+            count += generateQuiets(list + count);
+            for (int i = 0; i < count; i++) {
+                int other = moveFrom(list[i]);
+                if (other == from || moveTo(list[i]) != to || PIECE_TYPE(squares[other]) != type) { continue; }
+                Position next = *this;
+                next.makeMove(list[i]);
+                if (!next.wasLegal()) { continue; }
+                ambiguous = true;
+                sameFile |= FILE_OF(other) == FILE_OF(from);
+                sameRank |= RANK_OF(other) == RANK_OF(from);
+            }
+            if (ambiguous) {
+                if (!sameFile) { san += char('a' + FILE_OF(from)); }
+                else if (!sameRank) { san += char('1' + RANK_OF(from)); }
+                else { san += squareToString(from); }
+            }
+        }
+        if (isCapture(m)) { san += 'x'; }
+        san += squareToString(to);
+        if (isPromotion(m)) { san += std::string("=") + "NBRQ"[promotionType(m) - KNIGHT]; }
+        return san;
+    }
+
+    // Accepts SAN (check and annotation marks ignored) or UCI, NULL_MOVE if no legal move matches
+    Move parseMove(std::string text) const{
+        while (!text.empty() && std::string("+#!?").find(text.back()) != std::string::npos) { text.pop_back(); }
+        if (text == "0-0") { text = "O-O"; }
+        if (text == "0-0-0") { text = "O-O-O"; }
+        Move list[MAX_MOVES];
+        int count = generateCaptures(list);
+        count += generateQuiets(list + count);
+        for (int i = 0; i < count; i++) {
+            Position next = *this;
+            next.makeMove(list[i]);
+            if (!next.wasLegal()) { continue; }
+            if (moveToUci(list[i]) == text || moveToSan(list[i]) == text) { return list[i]; }
+        }
+        return NULL_MOVE;
+    }
+};
+
+// Draw rules shared by the searches. keyAt(i) is the key of position i of the game followed by the
+// search path, last is the current one, and only the reversible plies before it (no capture, pawn
+// move or null move since) can repeat it. A checkmate given on the hundredth half move still counts.
+template<typename KeyAt>
+bool isDraw(const Position &position, KeyAt keyAt, int last, int reversible){
+    uint64_t key = keyAt(last);
+    for (int i = last - 2; i >= std::max(0, last - reversible); i -= 2) {
+        if (keyAt(i) == key) { return true; }
+    }
+    if (position.isInsufficientMaterial()) { return true; }
+    return position.halfmoveClock >= 100 && (!position.inCheck() || position.hasLegalMove());
+}
+
+uint64_t perft(const Position &pos, int depth){
+    if (depth == 0) { return 1; }
+    Move list[MAX_MOVES];
+    int count = pos.generateCaptures(list);
+    count += pos.generateQuiets(list + count);
+    uint64_t nodes = 0;
+    for (int i = 0; i < count; i++) {
+        Position next = pos;
+        next.makeMove(list[i]);
+        if (next.wasLegal()) { nodes += perft(next, depth - 1); }
+    }
+    return nodes;
+}
+
+}
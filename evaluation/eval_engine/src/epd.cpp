@@ -0,0 +1,196 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "search.hpp"
+
+// Runs an EPD test suite (bm / am operations) over a pool of search threads
+namespace epd
+{
+    struct EpdPosition{
+        std::string id;
+        std::string fen;
+        std::vector<bitboard::Move> bestMoves;
+        std::vector<bitboard::Move> avoidMoves;
+    };
+
+    struct EpdResult{
+        bool solved = false;
+        bitboard::Move move = bitboard::NULL_MOVE;
+        double solveSeconds = -1;   // Time of the iteration from which the answer stayed correct
+        uint64_t nodes = 0;
+        int depth = 0;
+    };
+
+    std::string trim(const std::string &text){
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) { return ""; }
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    // "<placement> <side> <castling> <ep> op arg...; op arg...;"
+    bool parseLine(const std::string &line, EpdPosition &out){
+        std::istringstream ss(line);
+        std::string placement, side, castling, ep;
+        if (!(ss >> placement >> side >> castling >> ep)) { return false; }
+        out.fen = placement + " " + side + " " + castling + " " + ep + " 0 1";
+        bitboard::Position position(out.fen);
+
+        std::string operations;
+        std::getline(ss, operations);
+        std::istringstream ops(operations);
+        std::string operation;
+        while (std::getline(ops, operation, ';')) {
+            std::istringstream words(trim(operation));
+            std::string opcode, operand;
+            words >> opcode;
+            std::vector<bitboard::Move> *moves = opcode == "bm" ? &out.bestMoves
+                                               : opcode == "am" ? &out.avoidMoves : nullptr;
+            if (opcode == "id") {
+                std::getline(words, operand);
+                operand = trim(operand);
+                operand.erase(std::remove(operand.begin(), operand.end(), '"'), operand.end());
+                out.id = operand;
+            }
+            while (moves && words >> operand) {
+                bitboard::Move m = position.parseMove(operand);
+                if (m == bitboard::NULL_MOVE) {
+                    std::cerr << "---> Unknown move " << operand << " in: " << line << "\n";
+                    continue;
+                }
+                moves->push_back(m);
+            }
+        }
+        return !out.bestMoves.empty() || !out.avoidMoves.empty();
+    }
+
+    bool isCorrect(const EpdPosition &position, bitboard::Move m){
+        if (m == bitboard::NULL_MOVE) { return false; }
+        if (!position.bestMoves.empty()
+            && std::find(position.bestMoves.begin(), position.bestMoves.end(), m) == position.bestMoves.end()) {
+            return false;
+        }
+        return std::find(position.avoidMoves.begin(), position.avoidMoves.end(), m) == position.avoidMoves.end();
+    }
+
+    EpdResult solve(chess::blindSearch &search, const EpdPosition &position, const chess::SearchLimits &limits){
+        chess::SearchResult found = search.search(chess::GameHistory(position.fen), limits);
+        EpdResult result;
+        result.move = found.bestMove;
+        result.nodes = found.nodes;
+        result.depth = found.depth;
+        result.solved = isCorrect(position, found.bestMove);
+        if (result.solved) {
+            result.solveSeconds = found.seconds;
+            for (auto it = found.iterations.rbegin(); it != found.iterations.rend() && isCorrect(position, it->bestMove); ++it) {
+                result.solveSeconds = it->seconds;
+            }
+        }
+        return result;
+    }
+
+    double percentile(std::vector<double> values, double fraction){
+        if (values.empty()) { return 0; }
+        std::sort(values.begin(), values.end());
+        size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+        return values[index];
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: epd <file> [--threads N] [--time seconds] [--nodes N] [--depth D] [--hash MB] [-v]\n";
+        return 1;
+    }
+    std::string fileName = argv[1];
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t hashMB = 16;
+    bool verbose = false;
+    chess::SearchLimits limits;
+    limits.depth = chess::MAX_PLY - 1;
+    limits.seconds = 1;
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--threads" && hasValue) { threadCount = std::max(1, std::stoi(argv[++i])); }
+        else if (option == "--time" && hasValue) { limits.seconds = std::stod(argv[++i]); }
+        else if (option == "--nodes" && hasValue) { limits.nodes = std::stoull(argv[++i]); limits.seconds = 0; }
+        else if (option == "--depth" && hasValue) { limits.depth = std::stoi(argv[++i]); limits.seconds = 0; }
+        else if (option == "--hash" && hasValue) { hashMB = std::stoul(argv[++i]); }
+        else if (option == "-v") { verbose = true; }
+        else { std::cerr << "---> Unknown option: " << option << "\n"; return 1; }
+    }
+
+    bitboard::initTables();
+    std::ifstream file(fileName);
+    if (!file) { std::cerr << "---> Cannot open " << fileName << "\n"; return 1; }
+    std::vector<epd::EpdPosition> positions;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = epd::trim(line);
+        if (line.empty() || line[0] == '#') { continue; }
+        epd::EpdPosition position;
+        try {
+            if (epd::parseLine(line, position)) { positions.push_back(position); }
+            else { std::cerr << "---> Skipped, no bm or am: " << line << "\n"; }
+        }
+        catch (const std::exception &e) {
+            std::cerr << e.what() << "\n";
+        }
+    }
+
+    // Workers pull the next position from a shared counter, each with its own context and hash table
+    std::vector<epd::EpdResult> results(positions.size());
+    std::atomic<size_t> nextPosition(0);
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([&]() {
+            chess::blindSearch search;
+            chess::TranspositionTable table(hashMB);
+            search.table = &table;
+            for (size_t i; (i = nextPosition++) < positions.size(); ) {
+                table.clear();
+                results[i] = epd::solve(search, positions[i], limits);
+            }
+        });
+    }
+    for (std::thread &worker : workers) { worker.join(); }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    size_t solved = 0;
+    uint64_t totalNodes = 0;
+    std::vector<double> solveTimes;
+    for (size_t i = 0; i < positions.size(); i++) {
+        const epd::EpdResult &result = results[i];
+        totalNodes += result.nodes;
+        if (result.solved) { solved++; solveTimes.push_back(result.solveSeconds); }
+        if (verbose || !result.solved) {
+            bitboard::Position position(positions[i].fen);
+            std::cout << (result.solved ? "solved " : "failed ")
+                      << (positions[i].id.empty() ? std::to_string(i + 1) : positions[i].id)
+                      << ": " << (result.move == bitboard::NULL_MOVE ? "NULL" : position.moveToSan(result.move))
+                      << " depth " << result.depth << " nodes " << result.nodes;
+            if (result.solved) { std::cout << " found after " << result.solveSeconds << "s"; }
+            std::cout << "\n";
+        }
+    }
+
+    std::cout << "\nSolved: " << solved << " / " << positions.size() << "\n"
+              << "Threads: " << threadCount << "\n"
+              << "Time to Solution p50: " << epd::percentile(solveTimes, 0.50) << "s"
+              << " p90: " << epd::percentile(solveTimes, 0.90) << "s"
+              << " p99: " << epd::percentile(solveTimes, 0.99) << "s"
+              << " max: " << epd::percentile(solveTimes, 1.0) << "s\n"
+              << "Total Nodes: " << totalNodes << "\n"
+              << "Duration: " << wallSeconds << " second\n"
+              << "Nodes/second: " << (uint64_t)(totalNodes / std::max(wallSeconds, 1e-9)) << "\n";
+    return 0;
+}
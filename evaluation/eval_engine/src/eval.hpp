@@ -1,9 +1,11 @@
+#pragma once
 #include <iostream>
 #include <string>
 #include <iostream>
 #include <cstdlib>  
 #include <string> 
 #include <unordered_map>
+#include <cstdint>
 
 namespace eval{
 
@@ -231,7 +233,7 @@ void init_tables()  // take to compile time ??
     isInitialized = true;
 }
 
-int eval()
+int evalBoard(const int *pieceBoard, int side)
 {
     int mg[2];
     int eg[2];
@@ -244,7 +246,7 @@ int eval()
 
     /* evaluate each piece */
     for (int sq = 0; sq < 64; ++sq) {
-        int pc = board[sq];
+        int pc = pieceBoard[sq];
         if (pc != EMPTY) {
             mg[PCOLOR(pc)] += mg_table[pc][sq];
             eg[PCOLOR(pc)] += eg_table[pc][sq];
@@ -253,8 +255,8 @@ int eval()
     }
 
     /* tapered eval */
-    int mgScore = mg[side2move] - mg[OTHER(side2move)];
-    int egScore = eg[side2move] - eg[OTHER(side2move)];
+    int mgScore = mg[side] - mg[OTHER(side)];
+    int egScore = eg[side] - eg[OTHER(side)];
     int mgPhase = gamePhase;
     if (mgPhase > 24) mgPhase = 24; /* in case of early promotion */
     int egPhase = 24 - mgPhase;
@@ -262,6 +264,11 @@ int eval()
     return (mgScore * mgPhase + egScore * egPhase) / 24;
 }
 
+int eval()
+{
+    return evalBoard(board, side2move);
+}
+
 std::unordered_map<char, int> pieceMap = {
     {'P', WHITE_PAWN}, {'p', BLACK_PAWN},
     {'N', WHITE_KNIGHT}, {'n', BLACK_KNIGHT},
@@ -306,6 +313,48 @@ int evaluateBoard(const std::string &fen) {
 
 }
 
+int evaluateSquares(const int *squares) { // squares indexed a1 = 0, does not touch the global board
+
+    if(isInitialized == false){ init_tables(); }
+    int flipped[64];
+    for (int sq = 0; sq < 64; sq++) {
+        flipped[FLIP(sq)] = squares[sq];
+    }
+    return evalBoard(flipped, WHITE);
+
+}
+
+// Sums one color's pieces straight from its bitboards (a1 = 0), no 64-square scan
+template<int Color>
+inline void accumulatePieces(const uint64_t *pieces, int &mg, int &eg, int &gamePhase)
+{
+    for (int pc = WHITE_PAWN + Color; pc <= WHITE_KING + Color; pc += 2) {
+        for (uint64_t bb = pieces[pc]; bb; bb &= bb - 1) {
+            int sq = FLIP(__builtin_ctzll(bb));
+            mg += mg_table[pc][sq];
+            eg += eg_table[pc][sq];
+        }
+        gamePhase += gamephaseInc[pc] * __builtin_popcountll(pieces[pc]);
+    }
+}
+
+// Same score as evalBoard, for Side to move, from the twelve piece bitboards
+template<int Side>
+int evalPieces(const uint64_t *pieces)
+{
+    if(isInitialized == false){ init_tables(); }
+    int mg[2] = {0, 0};
+    int eg[2] = {0, 0};
+    int gamePhase = 0;
+    accumulatePieces<WHITE>(pieces, mg[WHITE], eg[WHITE], gamePhase);
+    accumulatePieces<BLACK>(pieces, mg[BLACK], eg[BLACK], gamePhase);
+
+    int mgScore = mg[Side] - mg[OTHER(Side)];
+    int egScore = eg[Side] - eg[OTHER(Side)];
+    int mgPhase = gamePhase > 24 ? 24 : gamePhase;
+    return (mgScore * mgPhase + egScore * (24 - mgPhase)) / 24;
+}
+
 void printIntBoard() {
     for (int i = 0; i < 64; i++) {
         if (i % 8 == 0) {
@@ -1,10 +1,107 @@
 #include <string>
-#include "main.cpp"
+#include "search.hpp"
+#include "scheduler.hpp"
 
 extern "C" {
     const char* get_best_move(const char* fen) {
         static std::string bestMove;
-        bestMove = chess::getBestMove(fen);
+        try {
+            bestMove = chess::blindSearch::getBestMove(fen);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            bestMove = "NULL";
+        }
         return bestMove.c_str();
     }
-}
\ No newline at end of file
+
+    // moves: space separated UCI moves played from fen, so repetitions and the fifty-move rule are known
+    const char* get_best_move_from_moves(const char* fen, const char* moves) {
+        static std::string bestMove;
+        try {
+            bestMove = chess::blindSearch::getBestMove(chess::GameHistory(fen, chess::splitMoves(moves)));
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            bestMove = "NULL";
+        }
+        return bestMove.c_str();
+    }
+
+    // Top multiPv moves with exact scores, as UCI "info ... multipv k score ... pv ..." lines, best first
+    const char* get_best_moves_multipv(const char* fen, const char* moves, int multiPv, int depth) {
+        static std::string info;
+        try {
+            chess::SearchLimits limits;
+            limits.depth = depth > 0 ? depth : chess::MAX_SEARCH_DEPTH;
+            limits.multiPv = multiPv;
+            chess::GameHistory game(fen, chess::splitMoves(moves));
+            info = chess::blindSearch::uciInfo(chess::blindSearch::shared().search(game, limits));
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            info = "";
+        }
+        return info.c_str();
+    }
+
+    // Keeps the game's hash table in a file so a correspondence game resumes warm after days or a
+    // restart. get_best_move_scheduled searches it for that gameId; games giving the same path share
+    // one table. The file is flushed whenever no search is running on it. Returns 1 if the file's
+    // entries were reused, 0 if it was (re)initialized, -1 if it could not be opened.
+    int open_hash_file(const char* gameId, const char* path, int sizeMB) {
+        return chess::hashFiles.open(gameId, path, sizeMB > 0 ? sizeMB : 16);
+    }
+
+    // The game goes back to the process-wide table; its file is closed once no search uses it
+    void close_hash_file(const char* gameId) {
+        chess::hashFiles.close(gameId);
+    }
+
+    // Cores the scheduler may use for all concurrent games together, waits for running searches first
+    void set_core_budget(int cores) {
+        chess::coreScheduler().setBudget(cores);
+    }
+
+    // Thread-safe: one call per game in flight. The scheduler splits the core budget between
+    // the calls by remaining clock; clockMs <= 0 searches to the default depth instead.
+    const char* get_best_move_scheduled(const char* gameId, const char* fen, const char* moves, int clockMs, int incrementMs) {
+        thread_local std::string bestMove;
+        try {
+            chess::GameHistory game(fen, chess::splitMoves(moves));
+            chess::SearchResult result = chess::coreScheduler().search(gameId, game, clockMs / 1000.0, incrementMs / 1000.0);
+            bestMove = bitboard::moveToUci(result.bestMove);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            bestMove = "NULL";
+        }
+        return bestMove.c_str();
+    }
+
+    // Per-game latency, queue wait, thread time and pool utilisation as JSON
+    const char* get_scheduler_stats() {
+        thread_local std::string stats;
+        stats = chess::coreScheduler().statsJson();
+        return stats.c_str();
+    }
+
+    // Monte Carlo tree search; the tree below the moves played since the previous call is kept
+    const char* get_best_move_mcts(const char* fen, const char* moves, unsigned long long playouts, int threads) {
+        static std::string bestMove;
+        try {
+            bestMove = chess::getBestMoveMcts(chess::GameHistory(fen, chess::splitMoves(moves)), playouts, threads);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            bestMove = "NULL";
+        }
+        return bestMove.c_str();
+    }
+
+    // Nodes per MCTS arena (two are kept); an expansion takes one node per legal move, so a
+    // playout costs about 30 nodes. Takes effect on the next search, which starts a new tree.
+    void set_mcts_arena_nodes(unsigned int nodes) {
+        chess::mcts.arenaCapacity = std::max(nodes, 1024u);
+    }
+
+    // Playouts the last MCTS search completed; below the requested count when the arena filled up
+    unsigned long long get_mcts_playouts() {
+        return chess::mcts.playouts.load();
+    }
+}
@@ -1,544 +1,277 @@
-#include <Python.h>
 #include <iostream>
-#include <unistd.h>
-#include <limits.h>
 #include <string>
-#include <cstdlib>
 #include <vector>
-#include <thread>
-#include <fstream>
-#include <ctime>
-#include <iomanip>
 #include <chrono>
-#include <algorithm>
-#include "eval.hpp"
+#include "search.hpp"
+#include "scheduler.hpp"
+#include "uci.hpp"
 
-const char *D_INTERPRETER_PATH = std::getenv("D_INTERPRETER_PATH");
-const char *D_SOURCE_PATH = std::getenv("D_SOURCE_PATH");
-
-namespace py
+namespace chess
 {
+    const std::vector<std::string> BENCH_POSITIONS = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+        "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1"
+    };
 
-    PyObject *name = nullptr;
-    PyObject *load_module = nullptr;
-
-    void initializePython()
-    {
-        // Check if env. vars valid
-        if (D_INTERPRETER_PATH == nullptr || D_SOURCE_PATH == nullptr)
-        {
-            throw std::runtime_error("---> Environment variables D_INTERPRETER_PATH or D_SOURCE_PATH are not set");
-        }
-
-        // Set env. vars
-        Py_Initialize();
-        PyObject *sys_path = PySys_GetObject("path");
-        if (sys_path == nullptr)
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Failed to get sys.path");
-        }
-        PyList_Append(sys_path, PyUnicode_FromString(D_SOURCE_PATH));
-        PyList_Append(sys_path, PyUnicode_FromString(D_INTERPRETER_PATH));
-
-        // Load module
-        name = PyUnicode_FromString((char *)"script");
-        load_module = PyImport_Import(name);
+    // Searches the bench positions to a fixed depth from a cold hash table and prints the counters
+    void runBench(const std::string &label, int searchDepth){
+        MovePicker::captureGenerations = MovePicker::quietGenerations = MovePicker::movesGenerated = 0;
+        boardState::bsCounter = 0;
+        tt.clear();
 
-        if (name == nullptr || load_module == nullptr)
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Failed to load module");
+        auto begin = std::chrono::steady_clock::now();
+        for(const std::string &fen : BENCH_POSITIONS){
+            blindSearch::getBestMove(fen, searchDepth);
         }
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - begin).count();
+
+        std::cout << "\n" << label << "\n"
+                  << "Search Depth: " << searchDepth << "\n"
+                  << "Nodes: " << boardState::bsCounter << "\n"
+                  << "Duration: " << seconds << " second\n"
+                  << "Nodes/second: " << (uint64_t)(boardState::bsCounter / std::max(seconds, 1e-9)) << "\n"
+                  << "Capture Generations: " << MovePicker::captureGenerations << "\n"
+                  << "Quiet Generations: " << MovePicker::quietGenerations << "\n"
+                  << "Moves Generated: " << MovePicker::movesGenerated << "\n";
     }
 
-    void finalizePython()
-    {
-        // Set reference counts to 0 for python gc
-        Py_SET_REFCNT(name, 0);
-        Py_SET_REFCNT(load_module, 0);
-        Py_Finalize();
+    // Staged against eager (full legal list per node) move generation
+    void bench(int searchDepth){
+        MovePicker::staged = false;
+        runBench("Move Generation: eager", searchDepth);
+        MovePicker::staged = true;
+        runBench("Move Generation: staged", searchDepth);
     }
 
-    void testFunction()
-    {
-        // Call function
-        PyObject *func = PyObject_GetAttrString(py::load_module, (char *)"testFunction");
-        PyObject *callfunc = PyObject_CallObject(func, NULL);
-        if (PyErr_Occurred())
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Error in testFunction");
+    // Time to depth with everything on, with each selective technique off in turn, and with all of them off
+    void benchSelective(int searchDepth){
+        const std::pair<const char*, bool SelectiveSearch::*> options[] = {
+            {"null move pruning", &SelectiveSearch::nullMovePruning},
+            {"null move verification", &SelectiveSearch::nullMoveVerification},
+            {"late move reductions", &SelectiveSearch::lateMoveReductions},
+            {"reverse futility pruning", &SelectiveSearch::reverseFutilityPruning},
+            {"futility pruning", &SelectiveSearch::futilityPruning},
+            {"mate distance pruning", &SelectiveSearch::mateDistancePruning}
+        };
+        runBench("Selective Search: all on", searchDepth);
+        for(const auto &option : options){
+            selective = SelectiveSearch();
+            selective.*option.second = false;
+            runBench(std::string("Selective Search: without ") + option.first, searchDepth);
         }
-        double result = PyFloat_AsDouble(callfunc);
-        std::cout << "Result: " << result << std::endl;
-
-        // Set reference counts to 0 for python gc,
-        Py_XDECREF(callfunc);
-        Py_XDECREF(func);
+        for(const auto &option : options){ selective.*option.second = false; }
+        runBench("Selective Search: all off", searchDepth);
+        selective = SelectiveSearch();
     }
 
-    bool isCheckmate(const std::string &fenBoard)
-    {
-        // Call function with fen arg
-        PyObject *func = PyObject_GetAttrString(py::load_module, (char *)"is_checkmate");
-        PyObject *args = PyTuple_Pack(1, PyUnicode_FromString(fenBoard.c_str()));
-        PyObject *callfunc = PyObject_CallObject(func, args);
-        if (PyErr_Occurred())
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Error in isCheckmate");
+    // Time to depth of MultiPV search against single-PV on the bench positions, cold hash table each time
+    void benchMultiPv(int multiPv, int searchDepth){
+        for(int lines : {1, multiPv}){
+            SearchLimits limits;
+            limits.depth = searchDepth;
+            limits.multiPv = lines;
+            blindSearch search;
+            uint64_t nodes = 0;
+            double seconds = 0;
+            for(const std::string &fen : BENCH_POSITIONS){
+                tt.clear();
+                SearchResult result = search.search(GameHistory(fen), limits);
+                nodes += result.nodes;
+                seconds += result.seconds;
+            }
+            std::cout << "\nMultiPV: " << lines << "\n"
+                      << "Search Depth: " << searchDepth << "\n"
+                      << "Nodes: " << nodes << "\n"
+                      << "Duration: " << seconds << " second\n";
         }
-        bool res = PyObject_IsTrue(callfunc);
-
-        // Set reference counts
-        Py_XDECREF(callfunc);
-        Py_XDECREF(args);
-        Py_XDECREF(func);
-
-        return res;
     }
 
-    bool isStalemate(const std::string &fenBoard)
-    {
-        // Call function with fen arg
-        PyObject *func = PyObject_GetAttrString(py::load_module, (char *)"is_stalemate");
-        PyObject *args = PyTuple_Pack(1, PyUnicode_FromString(fenBoard.c_str()));
-        PyObject *callfunc = PyObject_CallObject(func, args);
-        if (PyErr_Occurred())
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Error in is_stalemate");
-        }
-        bool res = PyObject_IsTrue(callfunc);
-
-        // Set reference counts
-        Py_XDECREF(callfunc);
-        Py_XDECREF(args);
-        Py_XDECREF(func);
-
-        return res;
+    void multiPv(int lines, int searchDepth, const std::string &fenBoard){
+        SearchLimits limits;
+        limits.depth = searchDepth;
+        limits.multiPv = lines;
+        SearchResult result = blindSearch::shared().search(GameHistory(fenBoard), limits);
+        std::cout << blindSearch::uciInfo(result) << "bestmove " << bitboard::moveToUci(result.bestMove) << "\n";
     }
 
-    bool isInsufficientMaterial(const std::string &fenBoard)
-    {
-        // Call function with fen arg
-        PyObject *func = PyObject_GetAttrString(py::load_module, (char *)"is_insufficient_material");
-        PyObject *args = PyTuple_Pack(1, PyUnicode_FromString(fenBoard.c_str()));
-        PyObject *callfunc = PyObject_CallObject(func, args);
-        if (PyErr_Occurred())
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Error in is_insufficient_material");
-        }
-        bool res = PyObject_IsTrue(callfunc);
-
-        // Set reference counts
-        Py_XDECREF(callfunc);
-        Py_XDECREF(args);
-        Py_XDECREF(func);
-
-        return res;
+    // Searches with the hash table in a file: run it twice to see the second search start warm
+    void persistentSearch(const std::string &path, int searchDepth, const std::string &fenBoard){
+        int opened = tt.mapFile(path, 16);
+        std::cout << "Hash File: " << path << (opened == 1 ? " (reused)" : opened == 0 ? " (new)" : " (unusable, in memory)") << "\n";
+        SearchLimits limits;
+        limits.depth = searchDepth;
+        SearchResult result = blindSearch::shared().search(GameHistory(fenBoard), limits); // Flushed as it ends
+        std::cout << blindSearch::uciInfo(result) << "bestmove " << bitboard::moveToUci(result.bestMove) << "\n";
     }
-        
-    bool isGameOver(const std::string &fenBoard)
-    {
-        // Call function with fen arg
-        PyObject *func = PyObject_GetAttrString(py::load_module, (char *)"is_game_over");
-        PyObject *args = PyTuple_Pack(1, PyUnicode_FromString(fenBoard.c_str()));
-        PyObject *callfunc = PyObject_CallObject(func, args);
-        if (PyErr_Occurred())
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Error in is_game_over");
-        }
-        bool res = PyObject_IsTrue(callfunc);
 
-        // Set reference counts
-        Py_XDECREF(callfunc);
-        Py_XDECREF(args);
-        Py_XDECREF(func);
-
-        return res;
-    }
-    
-    bool isDraw(const std::string &fenBoard){
-        // Call function with fen arg
-        PyObject *func = PyObject_GetAttrString(py::load_module, (char *)"is_draw");
-        PyObject *args = PyTuple_Pack(1, PyUnicode_FromString(fenBoard.c_str()));
-        PyObject *callfunc = PyObject_CallObject(func, args);
-        if (PyErr_Occurred())
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Error in is_draw");
+    // Plays a few moves in several games at once through the scheduler, game i with i+1 times
+    // the base clock, and prints the per-game latency and pool utilisation
+    void benchScheduler(int games, int cores, double clockSeconds){
+        CoreScheduler scheduler(cores);
+        std::vector<std::thread> players;
+        for(int i = 0; i < games; i++){
+            players.emplace_back([&, i](){
+                GameHistory game(BENCH_POSITIONS[i % BENCH_POSITIONS.size()]);
+                double clock = clockSeconds * (i + 1);
+                for(int move = 0; move < 4; move++){
+                    auto begin = std::chrono::steady_clock::now();
+                    SearchResult result = scheduler.search("game" + std::to_string(i), game, clock, 0);
+                    if(result.bestMove == bitboard::NULL_MOVE){ break; }
+                    clock -= std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                    game.play(result.bestMove);
+                }
+            });
         }
-        bool res = PyObject_IsTrue(callfunc);
-
-        // Set reference counts
-        Py_XDECREF(callfunc);
-        Py_XDECREF(args);
-        Py_XDECREF(func);
-
-        return res;
-    }
-
-    bool isTurnWhite(const std::string &fen) {
-        return fen.find("w") != std::string::npos;
+        for(std::thread &player : players){ player.join(); }
+        std::cout << scheduler.statsJson() << "\n";
     }
 
-    std::vector<std::string> generateLegalMoves(const std::string &fenBoard) {
-        // Call function with fen arg
-        PyObject *func = PyObject_GetAttrString(py::load_module, "generate_legal_moves");
-        if (!func || !PyCallable_Check(func)) {
-            PyErr_Print();
-            throw std::runtime_error("Error: generate_legal_moves function not found or not callable");
+    // Searches a position, plays the chosen move and searches again so subtree reuse shows up
+    void benchMcts(uint64_t playouts, int threads, const std::string &fenBoard){
+        GameHistory game(fenBoard);
+        for(int move = 0; move < 2; move++){
+            std::string bestMove = getBestMoveMcts(game, playouts, threads);
+            std::cout << "Threads: " << threads << "\n";
+            mcts.printStats();
+            if(bestMove == "NULL"){ break; }
+            game.play(bestMove);
         }
-    
-        PyObject *args = PyTuple_Pack(1, PyUnicode_FromString(fenBoard.c_str()));
-        if (!args) {
-            PyErr_Print();
-            Py_XDECREF(func);
-            throw std::runtime_error("Error: Failed to create arguments tuple");
-        }
-    
-        PyObject *callfunc = PyObject_CallObject(func, args);
-        if (!callfunc) {
-            PyErr_Print();
-            Py_XDECREF(args);
-            Py_XDECREF(func);
-            throw std::runtime_error("Error: Failed to call generate_legal_moves");
-        }
-    
-        if (!PyList_Check(callfunc)) {
-            PyErr_Print();
-            Py_XDECREF(callfunc);
-            Py_XDECREF(args);
-            Py_XDECREF(func);
-            throw std::runtime_error("Error: Expected a list as return value");
-        }
-    
-        std::vector<std::string> res;
-        Py_ssize_t size = PyList_Size(callfunc);
-        for (Py_ssize_t i = 0; i < size; ++i) {
-            PyObject *item = PyList_GetItem(callfunc, i);
-            if (!item) {
-                PyErr_Print();
-                Py_XDECREF(callfunc);
-                Py_XDECREF(args);
-                Py_XDECREF(func);
-                throw std::runtime_error("Error: Failed to get item from list");
-            }
-            const char *move = PyUnicode_AsUTF8(item);
-            if (!move) {
-                PyErr_Print();
-                Py_XDECREF(callfunc);
-                Py_XDECREF(args);
-                Py_XDECREF(func);
-                throw std::runtime_error("Error: Failed to convert item to string");
-            }
-            res.push_back(move);
-        }
-    
-        // Check for errors
-        if (PyErr_Occurred()) {
-            PyErr_Print();
-            Py_XDECREF(callfunc);
-            Py_XDECREF(args);
-            Py_XDECREF(func);
-            throw std::runtime_error("Error in generateLegalMoves");
-        }
-    
-        // Decrease reference counts
-        Py_XDECREF(callfunc);
-        Py_XDECREF(args);
-        Py_XDECREF(func);
-    
-        return res;
     }
-    
-    std::string makeMove(const std::string &fenBoard, const std::string &move) // Returns new board
-    {
-        // Call function with fen arg
-        PyObject *func = PyObject_GetAttrString(py::load_module, (char *)"make_move");
-        PyObject *args = PyTuple_Pack(2, PyUnicode_FromString(fenBoard.c_str()), PyUnicode_FromString(move.c_str()));
-        PyObject *callfunc = PyObject_CallObject(func, args);
-        if (PyErr_Occurred())
-        {
-            PyErr_Print();
-            throw std::runtime_error("---> Error in makeMove");
-        }
-        std::string res = PyUnicode_AsUTF8(callfunc);
-
-        // Set reference counts
-        Py_XDECREF(callfunc);
-        Py_XDECREF(args);
-        Py_XDECREF(func);
 
-        return res;
+    std::vector<bitboard::SliderBackend> availableSliderBackends(){
+        std::vector<bitboard::SliderBackend> backends = { bitboard::SliderBackend::CLASSICAL, bitboard::SliderBackend::MAGIC };
+        if(bitboard::cpuHasPext()){ backends.push_back(bitboard::SliderBackend::PEXT); }
+        return backends;
     }
 
-    void printAllMoves(const std::vector<std::string> &moves)
-    {
-        for (int i = 0; i < moves.size(); i++)
-        {
-            std::cout << moves[i] << std::endl;
+    // Lookups per second of every slider backend on the same random occupancies
+    void benchSliders(){
+        bitboard::initTables();
+        bitboard::SliderBackend selected = bitboard::sliderBackend;
+        const int SAMPLES = 1 << 16, ROUNDS = 64;
+        std::vector<std::pair<int, bitboard::Bitboard>> samples(SAMPLES);
+        uint64_t seed = 12345;
+        for(auto &sample : samples){ // About a third of the board occupied
+            sample.first = (int)(bitboard::splitMix64(seed) & 63);
+            sample.second = bitboard::splitMix64(seed) & bitboard::splitMix64(seed);
         }
-    }
-   
-}
-
-namespace chess
-{
-    enum class Player{
-        WHITE_PLAYER,
-        BLACK_PLAYER
-    };
-
-    enum class GameState{
-        ONGOING,
-        WIN,
-        LOSE,
-        DRAW
-    };
-
-    std::string getCurrentTimeStamp() {
-        auto t = std::time(nullptr);
-        auto tm = *std::localtime(&t);
-        std::ostringstream oss;
-        oss << std::put_time(&tm, "%d.%m.%Y_%H:%M:%S");
-        return oss.str();
-    }
-    
-    const std::string timeStamp = getCurrentTimeStamp();
-    const int MAX_SEARCH_DEPTH = 3;
-    const int64_t WIN_SCORE = 1000000000;
-    const int64_t DRAW_SCORE = 0;
-    const int64_t LOST_SCORE = -1000000000;
-    bool stopSearch = false;
-    Player player;
-
-    int evaluate(const std::string &fenBoard){ 
-        if(player == Player::BLACK_PLAYER){ return -eval::evaluateBoard(fenBoard); }
-        return eval::evaluateBoard(fenBoard); 
-    }
-
-    int depthToBeSearched(const float secondsLeftToMakeMove){
-        throw std::runtime_error("Not implemented yet");
-    }
 
-    struct boardState{
-        static int bsCounter;
-        static int64_t bestScoresForDepth[MAX_SEARCH_DEPTH] ; // index: depth, value score
-
-        std::vector<std::string> legalMoves;
-        std::vector<boardState*> subBoardStates;
-        std::string fenBoard;
-        std::string prevMoveMade = "NULL";
-        
-        Player turn;
-        boardState* parentBS;
-        GameState gameState;
-        int64_t evaluationScore = -123456789;
-        signed short depth = -1;
-        bool worthSearching = true;
-
-        boardState(const std::string &fenBoard, int depth, boardState* parentBS = nullptr, std::string moveMade = "NULL"){
-            bsCounter++;
-            // Initialize vars
-            this->fenBoard = fenBoard;
-            this->depth = depth;
-            this->parentBS = parentBS;
-            this->prevMoveMade = moveMade;
-            legalMoves = py::generateLegalMoves(fenBoard);
-
-            // Check turn and evaluate board state
-            turn = py::isTurnWhite(fenBoard) ? Player::WHITE_PLAYER : Player::BLACK_PLAYER;
-            if(depth == 0){ chess::player = turn; }
-
-            if(depth == MAX_SEARCH_DEPTH){
-                evaluationScore = evaluate(fenBoard);
-            }
-            
-            if(legalMoves.empty()){
-                if(py::isCheckmate(fenBoard)){
-                    evaluationScore = WIN_SCORE;
-                    gameState = GameState::WIN;
-                }
-                else if(py::isDraw(fenBoard)){ 
-                    evaluationScore = DRAW_SCORE;
-                    gameState = GameState::DRAW;
-                }
-                else{
-                    evaluationScore = LOST_SCORE;
-                    gameState = GameState::LOSE;
-                }
-            }
-
-            
-        }
-
-
-        boardState* makeMove(const std::string moveToMake){
-            boardState *newBS = new boardState(py::makeMove(fenBoard, moveToMake), this->depth + 1, this, moveToMake);
-            subBoardStates.push_back(newBS);
-            return newBS;
-        }
-
-        void printToTextFile() {
-            std::string fileName = "ST/output_" + timeStamp + ".txt";
-            std::ofstream outFile(fileName, std::ios::app);
-            if (outFile.is_open()) {
-                // Add title line if the file is empty
-                if (outFile.tellp() == 0) {
-                    outFile << "ParentBoard\tFEN Board\tTurn\tGame State\tEvaluation Score\tDepth\tMoveMade\n";
+        std::cout << "Selected Backend: " << bitboard::sliderBackendName(selected) << "\n";
+        bitboard::Bitboard reference = 0;
+        for(bitboard::SliderBackend backend : availableSliderBackends()){
+            bitboard::sliderBackend = backend;
+            bitboard::Bitboard checksum = 0;
+            auto begin = std::chrono::steady_clock::now();
+            for(int round = 0; round < ROUNDS; round++){
+                for(const auto &sample : samples){
+                    checksum += bitboard::bishopAttacks(sample.first, sample.second) ^ bitboard::rookAttacks(sample.first, sample.second);
                 }
-                outFile << (parentBS ? "0x" + std::to_string(reinterpret_cast<uintptr_t>(parentBS)) : "0x0000000000") << "\t"
-                        << "\"" << fenBoard << "\"" << "\t"
-                        << (turn == Player::WHITE_PLAYER ? "WHITE" : "BLACK") << "\t"
-                        << (gameState == GameState::WIN ? "WIN" : 
-                            gameState == GameState::DRAW ? "DRAW" : 
-                            gameState == GameState::LOSE ? "LOSE" : "ONGOING") << "\t"
-                        << evaluationScore << "\t"
-                        << depth << "\t"
-                        << prevMoveMade << "\n";
-                outFile.close();
-            } else {
-                std::cerr << "Unable to open file" << std::endl;
             }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if(backend == bitboard::SliderBackend::CLASSICAL){ reference = checksum; }
+            double lookups = 2.0 * SAMPLES * ROUNDS;
+            std::cout << bitboard::sliderBackendName(backend) << ": "
+                      << seconds * 1e9 / lookups << " ns/lookup, "
+                      << (uint64_t)(lookups / seconds) << " lookups/second"
+                      << (checksum == reference ? "" : ", MISMATCH") << "\n";
         }
-
-        bool isBranchWorthSearching(){
-            throw std::runtime_error("Not implemented");
-            return 0;
-        }
-
-        bool isTurnMine(){ return turn == chess::player; }
-
-        ~boardState(){
-            for(int i=0; i < subBoardStates.size(); i++){
-                delete subBoardStates[i];
-            }
-            subBoardStates.clear();
-        }
-
-    };
-    
-    // Definitions for static variables
-    int boardState::bsCounter = 0;
-    int64_t boardState::bestScoresForDepth[MAX_SEARCH_DEPTH] = { INT64_MIN };
-
-    void stampTextFile(std::chrono::system_clock::time_point begin, std::chrono::system_clock::time_point end) {
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-        std::time_t begin_time_t = std::chrono::system_clock::to_time_t(begin);
-        std::time_t end_time_t = std::chrono::system_clock::to_time_t(end);
-        std::tm begin_local_time = *std::localtime(&begin_time_t);
-        std::tm end_local_time = *std::localtime(&end_time_t);
-        std::string fileName = "ST/output_" + chess::timeStamp + ".txt";
-        std::ofstream outFile(fileName, std::ios::app);
-        if (outFile.is_open()) {
-            outFile << "Begin Timestamp: " << std::put_time(&begin_local_time, "%H:%M:%S") << "." 
-                    << std::setw(6) << std::setfill('0') << (std::chrono::duration_cast<std::chrono::microseconds>(begin.time_since_epoch()).count() % 1000000) << "\n"
-                    << "End Timestamp: " << std::put_time(&end_local_time, "%H:%M:%S") << "." 
-                    << std::setw(6) << std::setfill('0') << (std::chrono::duration_cast<std::chrono::microseconds>(end.time_since_epoch()).count() % 1000000) << "\n"
-                    << "Duration: " << (float)duration/1000000 << " second\n"
-                    << "Board State Counter: " << boardState::bsCounter << "\n"
-                    << "Max Search Depth: " << MAX_SEARCH_DEPTH << "\n"
-                    << "Search Stopped Prematurely: " << (stopSearch ? "YES" : "NO") << "\n";
-            outFile.close();
-        } else {
-            std::cerr << "Unable to open file" << std::endl;
-        }
-        std::cout << "Duration: " << (float)duration/1000000 << " second\n";
-        std::cout << "Games Searched: " << boardState::bsCounter << "\n";
+        bitboard::sliderBackend = selected;
     }
-    
-
-    struct blindSearch{
-
-        static void updateBestScoresForDepth(){
-            // Check my notebook
-        }
-
-        static void getBestMoveHelper(boardState* board){
-
-            if(board->gameState != GameState::ONGOING && board->depth == 1){ // If there move to win do it
-                stopSearch = true;
-                return;
-            } 
-            else if(stopSearch || board->depth == MAX_SEARCH_DEPTH){
-                return;
-            }
 
-            if(board->isTurnMine()){ // If turn is mine then best move goes up
-                int64_t bestScore = INT64_MIN;
-                for(int i=0; i < board->legalMoves.size(); i++){
-                    boardState* subBS = board->makeMove(board->legalMoves.at(i));
-                    getBestMoveHelper(subBS);
-
-                    if(bestScore < subBS->evaluationScore){
-                        bestScore = subBS->evaluationScore;
-                    }
-                }
-                board->evaluationScore = bestScore;
+    // Perft of the bench positions under every slider backend; the counts must agree
+    bool perftSliderBackends(int depth){
+        bitboard::initTables();
+        bitboard::SliderBackend selected = bitboard::sliderBackend;
+        bool identical = true;
+        for(const std::string &fen : BENCH_POSITIONS){
+            bitboard::Position position(fen);
+            uint64_t reference = 0;
+            std::cout << fen << "\n";
+            for(bitboard::SliderBackend backend : availableSliderBackends()){
+                bitboard::sliderBackend = backend;
+                auto begin = std::chrono::steady_clock::now();
+                uint64_t nodes = bitboard::perft(position, depth);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                if(backend == bitboard::SliderBackend::CLASSICAL){ reference = nodes; }
+                identical = identical && nodes == reference;
+                std::cout << "  " << bitboard::sliderBackendName(backend) << ": Perft(" << depth << ") = " << nodes
+                          << " in " << seconds << " second" << (nodes == reference ? "" : " MISMATCH") << "\n";
             }
-            else{ // If opponent turn then best move for opponent goes up
-                int64_t worseScore = INT64_MIN;
-                for(int i=0; i < board->legalMoves.size(); i++){
-                    boardState* subBS = board->makeMove(board->legalMoves.at(i));
-                    getBestMoveHelper(subBS);
-
-                    if(worseScore > subBS->evaluationScore){
-                        worseScore = subBS->evaluationScore;
-                    }
-                }
-                board->evaluationScore = worseScore;
-            }
-
-            // *** Comment this in actual run
-            board->printToTextFile();
-            // ***
-            
         }
-
-        static std::string getBestMove(std::string fenBoard){
-            bool stopSearch = false;
-            std::string bestMove = "NULL";
-            boardState* board = new boardState(fenBoard, 0);
-            getBestMoveHelper(board);
-            int64_t bestScore = INT64_MIN;
-            for(int i=0; i < board->subBoardStates.size(); i++){
-                boardState* subBoard = board->subBoardStates.at(i);
-                if(bestScore < subBoard->evaluationScore){
-                    bestScore = subBoard->evaluationScore;
-                    bestMove = subBoard->prevMoveMade;
-                }
-            }
-            delete board;
-            std::cout << "\nBest Move Found: " << bestMove << "\n";
-            return bestMove;
-        }
-    
-    };
-    
-    std::chrono::time_point<std::chrono::system_clock> timeBegin;
-    std::chrono::time_point<std::chrono::system_clock> timeEnd;
-
-    void initialize(){
-        py::initializePython();
-        std::fill(boardState::bestScoresForDepth, boardState::bestScoresForDepth + MAX_SEARCH_DEPTH, INT64_MIN);
-        timeBegin = std::chrono::system_clock::now();
+        bitboard::sliderBackend = selected;
+        std::cout << (identical ? "All backends identical\n" : "Backends disagree\n");
+        return identical;
     }
 
-    void finalize(){
-        timeEnd = std::chrono::system_clock::now();
-        py::finalizePython();
-        stampTextFile(timeBegin, timeEnd);
+    void perft(int depth, const std::string &fenBoard){
+        bitboard::Position position(fenBoard);
+        auto begin = std::chrono::steady_clock::now();
+        uint64_t nodes = bitboard::perft(position, depth);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "Perft(" << depth << "): " << nodes << "\n"
+                  << "Duration: " << seconds << " second\n";
     }
 
 }
 
 int main(int argc, char *argv[])
 {
+    std::string command = argc > 1 ? argv[1] : "";
+    if(command == "uci"){ // output.o uci, then UCI commands on stdin
+        chess::uciLoop();
+        return 0;
+    }
+    if(command == "bench"){ // output.o bench [depth]
+        chess::bench(argc > 2 ? std::stoi(argv[2]) : chess::BENCH_DEPTH);
+        return 0;
+    }
+    if(command == "bench-selective"){ // output.o bench-selective [depth]
+        chess::benchSelective(argc > 2 ? std::stoi(argv[2]) : chess::BENCH_DEPTH);
+        return 0;
+    }
+    if(command == "mcts"){ // output.o mcts [playouts] [threads] [fen]
+        chess::benchMcts(argc > 2 ? std::stoull(argv[2]) : 100000, argc > 3 ? std::stoi(argv[3]) : 1,
+                         argc > 4 ? argv[4] : chess::BENCH_POSITIONS[0]);
+        return 0;
+    }
+    if(command == "multipv"){ // output.o multipv [lines] [depth] [fen]
+        chess::multiPv(argc > 2 ? std::stoi(argv[2]) : 3, argc > 3 ? std::stoi(argv[3]) : chess::BENCH_DEPTH,
+                       argc > 4 ? argv[4] : chess::BENCH_POSITIONS[0]);
+        return 0;
+    }
+    if(command == "bench-multipv"){ // output.o bench-multipv [lines] [depth]
+        chess::benchMultiPv(argc > 2 ? std::stoi(argv[2]) : 3, argc > 3 ? std::stoi(argv[3]) : chess::BENCH_DEPTH);
+        return 0;
+    }
+    if(command == "persist"){ // output.o persist file [depth] [fen]
+        if(argc < 3){ std::cerr << "Usage: output.o persist file [depth] [fen]\n"; return 1; }
+        chess::persistentSearch(argv[2], argc > 3 ? std::stoi(argv[3]) : chess::BENCH_DEPTH,
+                                argc > 4 ? argv[4] : chess::BENCH_POSITIONS[0]);
+        return 0;
+    }
+    if(command == "bench-scheduler"){ // output.o bench-scheduler [games] [cores] [clock seconds]
+        chess::benchScheduler(argc > 2 ? std::stoi(argv[2]) : 4, argc > 3 ? std::stoi(argv[3]) : 4,
+                              argc > 4 ? std::stod(argv[4]) : 2);
+        return 0;
+    }
+    if(command == "bench-sliders"){ // output.o bench-sliders
+        chess::benchSliders();
+        return 0;
+    }
+    if(command == "perft-sliders"){ // output.o perft-sliders [depth]
+        return chess::perftSliderBackends(argc > 2 ? std::stoi(argv[2]) : 4) ? 0 : 1;
+    }
+    if(command == "perft"){ // output.o perft depth [fen]
+        chess::perft(argc > 2 ? std::stoi(argv[2]) : 5, argc > 3 ? argv[3] : chess::BENCH_POSITIONS[0]);
+        return 0;
+    }
     
     chess::initialize();
     chess::blindSearch::getBestMove("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
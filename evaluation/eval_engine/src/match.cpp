@@ -0,0 +1,349 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include "search.hpp"
+#include "pgn.hpp"
+
+// Plays two UCI engines (two builds, or one build with different options) against each other
+// from an opening file, several games at once, and runs a sequential probability ratio test
+namespace match
+{
+    // A UCI engine running as a child process
+    struct EngineProcess{
+        std::string command;
+        std::vector<std::string> options;   // "Name=Value"
+        pid_t pid = -1;
+        int toEngine = -1, fromEngine = -1;
+        std::string buffer;
+
+        ~EngineProcess(){ quit(); }
+
+        bool start(){
+            // Close-on-exec, so engines started from other threads do not inherit these ends and
+            // keep a crashed engine's pipe open. dup2 clears the flag on the child's stdin/stdout.
+            int in[2], out[2];
+            if(pipe2(in, O_CLOEXEC) != 0){ return false; }
+            if(pipe2(out, O_CLOEXEC) != 0){ close(in[0]); close(in[1]); return false; }
+            std::string shellCommand = "exec " + command;  // No allocation between fork and exec
+            pid = fork();
+            if(pid == 0){
+                dup2(in[0], STDIN_FILENO);
+                dup2(out[1], STDOUT_FILENO);
+                execl("/bin/sh", "sh", "-c", shellCommand.c_str(), (char*)nullptr);
+                _exit(127);
+            }
+            close(in[0]);
+            close(out[1]);
+            toEngine = in[1];
+            fromEngine = out[0];
+            buffer.clear();
+            if(pid < 0){ return false; }
+            send("uci");
+            if(!waitFor("uciok", 10)){ return false; }
+            for(const std::string &option : options){
+                size_t equals = option.find('=');
+                send("setoption name " + option.substr(0, equals) + " value " + option.substr(equals + 1));
+            }
+            send("isready");
+            return waitFor("readyok", 10);
+        }
+
+        void quit(){
+            if(pid <= 0){ return; }
+            send("quit");
+            close(toEngine);
+            close(fromEngine);
+            for(int i = 0; i < 50 && waitpid(pid, nullptr, WNOHANG) == 0; i++){ usleep(10000); }
+            if(waitpid(pid, nullptr, WNOHANG) == 0){ kill(pid, SIGKILL); waitpid(pid, nullptr, 0); }
+            pid = -1;
+        }
+
+        void send(const std::string &line){
+            std::string data = line + "\n";
+            if(write(toEngine, data.data(), data.size()) < 0){ /* Engine died, reads will fail */ }
+        }
+
+        // False on timeout or when the engine has gone away
+        bool readLine(std::string &line, double timeoutSeconds){
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeoutSeconds);
+            while(true){
+                size_t newline = buffer.find('\n');
+                if(newline != std::string::npos){
+                    line = buffer.substr(0, newline);
+                    buffer.erase(0, newline + 1);
+                    return true;
+                }
+                double left = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+                if(left <= 0){ return false; }
+                pollfd fd{fromEngine, POLLIN, 0};
+                if(poll(&fd, 1, (int)std::ceil(left * 1000)) <= 0){ return false; }
+                char chunk[4096];
+                ssize_t count = read(fromEngine, chunk, sizeof(chunk));
+                if(count <= 0){ return false; }
+                buffer.append(chunk, count);
+            }
+        }
+
+        bool waitFor(const std::string &prefix, double timeoutSeconds, std::string *found = nullptr){
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeoutSeconds);
+            std::string line;
+            while(readLine(line, std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count())){
+                if(line.compare(0, prefix.size(), prefix) == 0){
+                    if(found){ *found = line; }
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    struct Opening{
+        std::string fen;
+        std::vector<std::string> moves;
+    };
+
+    // FEN/EPD lines, or PGN games whose moves are played out as the opening
+    std::vector<Opening> readOpenings(const std::string &fileName){
+        std::ifstream file(fileName);
+        if(!file){ throw std::runtime_error("---> Cannot open " + fileName); }
+        std::vector<Opening> openings;
+        std::string line, gameText;
+        auto flushGame = [&](){
+            if(gameText.find_first_not_of(" \t\r\n") == std::string::npos){ return; }
+            chess::PgnGame game = chess::parsePgn(gameText);
+            Opening opening{game.startFen, {}};
+            for(bitboard::Move move : game.moves){ opening.moves.push_back(bitboard::moveToUci(move)); }
+            openings.push_back(opening);
+            gameText.clear();
+        };
+        bool inMovetext = false;
+        while(std::getline(file, line)){
+            if(!line.empty() && line.back() == '\r'){ line.pop_back(); }
+            if(line.find_first_not_of(" \t") == std::string::npos){ continue; }
+            if(line[0] != '[' && chess::isFenLine(line)){
+                std::istringstream ss(line);
+                std::string placement, side, castling, ep;
+                ss >> placement >> side >> castling >> ep;
+                openings.push_back({placement + " " + side + " " + castling + " " + ep + " 0 1", {}});
+                continue;
+            }
+            if(line[0] == '[' && inMovetext){ flushGame(); inMovetext = false; }
+            inMovetext |= line[0] != '[';
+            gameText += line + "\n";
+        }
+        flushGame();
+        return openings;
+    }
+
+    struct TimeControl{
+        double base = 10;
+        double increment = 0.1;
+        double margin = 0.1;                // Allowed overrun before a loss on time
+    };
+
+    // Plays one game, engines[0] has the white pieces. Returns the result for white and the reason.
+    std::pair<double, std::string> playGame(EngineProcess *engines[2], const Opening &opening, const TimeControl &control,
+                                            int maxPlies){
+        chess::GameHistory game(opening.fen, opening.moves);
+        std::string moves;
+        for(const std::string &move : opening.moves){ moves += " " + move; }
+        double clock[2] = {control.base, control.base};
+        for(EngineProcess *engine : {engines[0], engines[1]}){
+            engine->send("ucinewgame");
+            engine->send("isready");
+            engine->waitFor("readyok", 10);
+        }
+
+        for(int ply = 0; ; ply++){
+            const bitboard::Position &position = game.position;
+            int side = position.side;
+            double sideWins = side == WHITE ? 1.0 : 0.0;
+
+            // Adjudicate finished games without asking the engines
+            if(!position.hasLegalMove()){
+                if(position.inCheck()){ return {1 - sideWins, "checkmate"}; }
+                return {0.5, "stalemate"};
+            }
+            if(position.halfmoveClock >= 100){ return {0.5, "fifty-move rule"}; }
+            if(position.isInsufficientMaterial()){ return {0.5, "insufficient material"}; }
+            if(std::count(game.keys.begin(), game.keys.end(), position.key) >= 3){ return {0.5, "threefold repetition"}; }
+            if(ply >= maxPlies){ return {0.5, "move limit"}; }
+
+            EngineProcess &engine = *engines[side == WHITE ? 0 : 1];
+            engine.send("position fen " + opening.fen + (moves.empty() ? "" : " moves" + moves));
+            engine.send("go wtime " + std::to_string((int64_t)(clock[WHITE] * 1000)) + " btime " + std::to_string((int64_t)(clock[BLACK] * 1000))
+                        + " winc " + std::to_string((int64_t)(control.increment * 1000)) + " binc " + std::to_string((int64_t)(control.increment * 1000)));
+            auto begin = std::chrono::steady_clock::now();
+            std::string reply;
+            bool answered = engine.waitFor("bestmove", clock[side] + control.margin, &reply);
+            clock[side] -= std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if(!answered || clock[side] < -control.margin){
+                if(!answered){ // Hung or crashed: start it over for the next game
+                    engine.quit();
+                    engine.start();
+                }
+                return {1 - sideWins, "loss on time"};
+            }
+            clock[side] += control.increment;
+
+            std::istringstream words(reply);
+            std::string token, uciMove;
+            words >> token >> uciMove;
+            if(position.parseUciMove(uciMove) == bitboard::NULL_MOVE){ return {1 - sideWins, "illegal move " + uciMove}; }
+            game.play(uciMove);
+            moves += " " + uciMove;
+        }
+    }
+
+    // Expected score of a player rated elo points above the opponent
+    double expectedScore(double elo){ return 1 / (1 + std::pow(10, -elo / 400)); }
+
+    double eloFromScore(double score){
+        score = std::min(std::max(score, 1e-6), 1 - 1e-6);
+        return -400 * std::log10(1 / score - 1);
+    }
+
+    struct Tally{
+        uint64_t wins = 0, draws = 0, losses = 0;
+
+        uint64_t games() const{ return wins + draws + losses; }
+        double score() const{ return (wins + 0.5 * draws) / std::max<uint64_t>(games(), 1); }
+
+        double variance() const{
+            double s = score();
+            double n = std::max<uint64_t>(games(), 1);
+            return (wins * std::pow(1 - s, 2) + draws * std::pow(0.5 - s, 2) + losses * std::pow(s, 2)) / n;
+        }
+
+        // Generalized SPRT log-likelihood ratio of elo1 against elo0, normal approximation of the trinomial
+        double llr(double elo0, double elo1) const{
+            double var = variance();
+            if(games() == 0 || var <= 0){ return 0; }
+            double s0 = expectedScore(elo0), s1 = expectedScore(elo1);
+            return (s1 - s0) * (2 * score() - s0 - s1) * games() / (2 * var);
+        }
+
+        // Elo difference and its 95% error margin
+        std::pair<double, double> elo() const{
+            double s = score();
+            double margin = 1.959964 * std::sqrt(variance() / std::max<uint64_t>(games(), 1));
+            double elo = eloFromScore(s);
+            return {elo, (eloFromScore(s + margin) - eloFromScore(s - margin)) / 2};
+        }
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    std::string usage = "Usage: match --engine1 \"cmd\" --engine2 \"cmd\" --openings file [--option1 Name=Value]... [--option2 Name=Value]...\n"
+                        "             [--games N] [--concurrency N] [--tc base+inc] [--margin seconds] [--max-plies N]\n"
+                        "             [--sprt elo0 elo1 alpha beta]\n";
+    match::EngineProcess prototypes[2];
+    std::string openingsFile;
+    uint64_t maxGames = 1000;
+    int concurrency = std::max(1u, std::thread::hardware_concurrency());
+    match::TimeControl control;
+    int maxPlies = 400;
+    double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+    for(int i = 1; i < argc; i++){
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(option == "--engine1" && hasValue){ prototypes[0].command = argv[++i]; }
+        else if(option == "--engine2" && hasValue){ prototypes[1].command = argv[++i]; }
+        else if(option == "--option1" && hasValue){ prototypes[0].options.push_back(argv[++i]); }
+        else if(option == "--option2" && hasValue){ prototypes[1].options.push_back(argv[++i]); }
+        else if(option == "--openings" && hasValue){ openingsFile = argv[++i]; }
+        else if(option == "--games" && hasValue){ maxGames = std::stoull(argv[++i]); }
+        else if(option == "--concurrency" && hasValue){ concurrency = std::max(1, std::stoi(argv[++i])); }
+        else if(option == "--tc" && hasValue){
+            std::string tc = argv[++i];
+            size_t plus = tc.find('+');
+            control.base = std::stod(tc.substr(0, plus));
+            control.increment = plus == std::string::npos ? 0 : std::stod(tc.substr(plus + 1));
+        }
+        else if(option == "--margin" && hasValue){ control.margin = std::stod(argv[++i]); }
+        else if(option == "--max-plies" && hasValue){ maxPlies = std::stoi(argv[++i]); }
+        else if(option == "--sprt" && i + 4 < argc){
+            elo0 = std::stod(argv[++i]); elo1 = std::stod(argv[++i]);
+            alpha = std::stod(argv[++i]); beta = std::stod(argv[++i]);
+        }
+        else{ std::cerr << usage; return 1; }
+    }
+    if(prototypes[0].command.empty() || prototypes[1].command.empty() || openingsFile.empty()){
+        std::cerr << usage;
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    bitboard::initTables();
+    std::vector<match::Opening> openings;
+    try{ openings = match::readOpenings(openingsFile); }
+    catch(const std::exception &e){ std::cerr << e.what() << "\n"; return 1; }
+    if(openings.empty()){ std::cerr << "---> No openings in " << openingsFile << "\n"; return 1; }
+
+    const double lowerBound = std::log(beta / (1 - alpha)), upperBound = std::log((1 - beta) / alpha);
+    match::Tally tally;
+    std::mutex tallyMutex;
+    std::atomic<uint64_t> nextGame(0);
+    std::atomic<bool> decided(false);
+
+    // Each opening is played twice with colors swapped; game g uses opening g / 2
+    auto worker = [&](){
+        match::EngineProcess engines[2];
+        for(int e = 0; e < 2; e++){
+            engines[e].command = prototypes[e].command;
+            engines[e].options = prototypes[e].options;
+            if(!engines[e].start()){ std::cerr << "---> Cannot start " << engines[e].command << "\n"; decided = true; return; }
+        }
+        for(uint64_t g; !decided && (g = nextGame++) < maxGames; ){
+            const match::Opening &opening = openings[(g / 2) % openings.size()];
+            bool firstIsWhite = g % 2 == 0;
+            match::EngineProcess *seats[2] = {&engines[firstIsWhite ? 0 : 1], &engines[firstIsWhite ? 1 : 0]};
+            std::pair<double, std::string> result;
+            try{ result = match::playGame(seats, opening, control, maxPlies); }
+            catch(const std::exception &e){ std::cerr << e.what() << "\n"; continue; }
+            double firstScore = firstIsWhite ? result.first : 1 - result.first;
+
+            std::lock_guard<std::mutex> lock(tallyMutex);
+            if(firstScore == 1){ tally.wins++; }
+            else if(firstScore == 0){ tally.losses++; }
+            else{ tally.draws++; }
+            double llr = tally.llr(elo0, elo1);
+            std::pair<double, double> elo = tally.elo();
+            std::cout << "Game " << g + 1 << " (" << (firstIsWhite ? "engine1 white" : "engine2 white") << "): "
+                      << (result.first == 1 ? "1-0" : result.first == 0 ? "0-1" : "1/2-1/2") << " " << result.second << "\n"
+                      << "Score of engine1 vs engine2: " << tally.wins << " - " << tally.losses << " - " << tally.draws
+                      << " [" << std::fixed << std::setprecision(3) << tally.score() << "] " << tally.games() << "\n"
+                      << "Elo difference: " << std::setprecision(1) << elo.first << " +/- " << elo.second
+                      << ", LLR: " << std::setprecision(2) << llr << " (" << lowerBound << ", " << upperBound << ")"
+                      << " [" << elo0 << ", " << elo1 << "]\n" << std::defaultfloat << std::flush;
+            if(!decided && (llr >= upperBound || llr <= lowerBound)){
+                decided = true;
+                std::cout << "SPRT: " << (llr >= upperBound ? "H1 accepted" : "H0 accepted") << "\n";
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for(int t = 0; t < concurrency; t++){ workers.emplace_back(worker); }
+    for(std::thread &thread : workers){ thread.join(); }
+
+    std::pair<double, double> elo = tally.elo();
+    std::cout << "\nFinished " << tally.games() << " games: " << tally.wins << " - " << tally.losses << " - " << tally.draws << "\n"
+              << std::fixed << std::setprecision(1) << "Elo difference: " << elo.first << " +/- " << elo.second << "\n"
+              << std::setprecision(2) << "LLR: " << tally.llr(elo0, elo1) << " (" << lowerBound << ", " << upperBound << ")\n";
+    return 0;
+}
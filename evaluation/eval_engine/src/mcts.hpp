@@ -0,0 +1,392 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include "bitboard.hpp"
+
+// Monte Carlo tree search with PUCT selection. Nodes live in a flat arena and
+// refer to each other by index; the children of a node are one contiguous block.
+
+namespace chess
+{
+    enum NodeState : uint8_t{
+        UNEXPANDED,
+        EXPANDING,      // Claimed by a thread, children not published yet
+        EXPANDED,
+        TERMINAL        // Mate or stalemate, terminalValue holds the result
+    };
+
+    const uint32_t NO_NODE = UINT32_MAX;
+
+    struct MctsNode{
+        std::atomic<uint32_t> visits;
+        std::atomic<int32_t> virtualLoss;   // Playouts currently passing through this node
+        std::atomic<int64_t> valueSum;      // Fixed point, for the side that moved into this node
+        uint32_t firstChild;
+        float prior;
+        float terminalValue;                // For the side to move
+        bitboard::Move move;
+        uint16_t childCount;
+        std::atomic<uint8_t> state;
+
+        void init(bitboard::Move moveMade, float moveprior){
+            visits.store(0, std::memory_order_relaxed);
+            virtualLoss.store(0, std::memory_order_relaxed);
+            valueSum.store(0, std::memory_order_relaxed);
+            firstChild = 0;
+            prior = moveprior;
+            terminalValue = 0;
+            move = moveMade;
+            childCount = 0;
+            state.store(UNEXPANDED, std::memory_order_relaxed);
+        }
+    };
+
+    struct NodeArena{
+        std::unique_ptr<MctsNode[]> nodes;
+        uint32_t capacity = 0;
+        std::atomic<uint32_t> used{0};
+
+        void reserve(uint32_t count){
+            if(capacity != count){
+                nodes.reset(new MctsNode[count]);
+                capacity = count;
+            }
+            used = 0;
+        }
+
+        // Nodes are initialised when handed out, so forgetting the whole tree is O(1)
+        void reset(){ used = 0; }
+
+        // First of count consecutive nodes, NO_NODE once the arena is exhausted
+        uint32_t allocate(uint32_t count){
+            uint32_t first = used.fetch_add(count, std::memory_order_relaxed);
+            return (uint64_t)first + count <= capacity ? first : NO_NODE;
+        }
+
+        uint32_t size() const{ return std::min(used.load(), capacity); }
+
+        MctsNode& operator[](uint32_t index){ return nodes[index]; }
+    };
+
+    struct MctsSearch{
+        static constexpr float CPUCT = 1.5f;
+        static constexpr float FIRST_PLAY_REDUCTION = 0.2f;  // Unvisited children start below their parent's value
+        static constexpr double VALUE_SCALE = 1 << 20;        // Fixed point for valueSum
+        static constexpr double EVAL_SCALE = 400.0;           // Centipawns mapped through tanh to [-1, 1]
+        static constexpr double PRIOR_TEMPERATURE = 150.0;    // Centipawns, softmax over child evaluations
+
+        uint32_t arenaCapacity = 1 << 21;  // Nodes per arena, an expansion takes one per legal move
+        int batchSize = 8;
+
+        NodeArena arenas[2];        // Live tree and spare, swapped when a subtree is kept
+        int current = 0;
+        uint32_t root = NO_NODE;
+        bitboard::Position rootPosition;
+        std::vector<uint64_t> rootKeys;
+
+        std::atomic<uint64_t> playouts{0};
+        std::atomic<uint64_t> collisions{0};
+        std::atomic<bool> stop{false};
+        std::atomic<bool> arenaFull{false}; // The last search stopped before its playout limit
+        uint32_t reusedNodes = 0;
+        double lastSeconds = 0;
+
+        struct Leaf{
+            std::vector<uint32_t> path;
+            std::vector<uint64_t> keys;     // Positions since the root
+            bitboard::Position position;
+            bool needsExpansion = false;
+            float value = 0;                // For the side to move at the leaf
+        };
+
+        NodeArena& arena(){ return arenas[current]; }
+
+        static int evaluate(const bitboard::Position &position){
+            int score = eval::evaluateSquares(position.squares);
+            return position.side == WHITE ? score : -score;
+        }
+
+        // Keys of the game followed by the keys since the root, as one sequence
+        bool isDraw(const Leaf &leaf) const{
+            auto keyAt = [&](int i){ return i < (int)rootKeys.size() ? rootKeys[i] : leaf.keys[i - rootKeys.size()]; };
+            int last = (int)(rootKeys.size() + leaf.keys.size()) - 1;
+            return bitboard::isDraw(leaf.position, keyAt, last, leaf.position.halfmoveClock);
+        }
+
+        uint32_t selectChild(MctsNode &node){
+            uint32_t parentVisits = node.visits.load(std::memory_order_relaxed) + node.virtualLoss.load(std::memory_order_relaxed);
+            float sqrtVisits = std::sqrt((float)std::max(parentVisits, 1u));
+            float parentValue = node.visits ? -(float)(node.valueSum.load(std::memory_order_relaxed) / VALUE_SCALE) / node.visits : 0;
+            float firstPlayValue = parentValue - FIRST_PLAY_REDUCTION;
+
+            uint32_t best = node.firstChild;
+            float bestScore = -1e9f;
+            for(uint32_t i = node.firstChild; i < node.firstChild + node.childCount; i++){
+                MctsNode &child = arena()[i];
+                uint32_t visits = child.visits.load(std::memory_order_relaxed);
+                int32_t inFlight = child.virtualLoss.load(std::memory_order_relaxed);
+                uint32_t n = visits + inFlight;
+                // Each playout still in flight counts as a loss, steering other threads elsewhere
+                float q = n ? (float)((child.valueSum.load(std::memory_order_relaxed) / VALUE_SCALE - inFlight) / n) : firstPlayValue;
+                float score = q + CPUCT * child.prior * sqrtVisits / (1 + n);
+                if(score > bestScore){
+                    bestScore = score;
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        void enter(Leaf &leaf, uint32_t index){
+            arena()[index].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+            leaf.path.push_back(index);
+        }
+
+        // Walks down from the root. False on a collision with a leaf another thread is expanding.
+        bool selectLeaf(Leaf &leaf){
+            leaf.path.clear();
+            leaf.keys.clear();
+            leaf.position = rootPosition;
+            leaf.needsExpansion = false;
+            uint32_t index = root;
+            enter(leaf, index);
+
+            while(true){
+                MctsNode &node = arena()[index];
+                uint8_t state = node.state.load(std::memory_order_acquire);
+                if(state == TERMINAL){
+                    leaf.value = node.terminalValue;
+                    return true;
+                }
+                if(leaf.path.size() > 1 && isDraw(leaf)){
+                    leaf.value = 0;
+                    return true;
+                }
+                if(state == UNEXPANDED){
+                    if(node.state.compare_exchange_strong(state, EXPANDING, std::memory_order_acq_rel)){
+                        leaf.needsExpansion = true;
+                        return true;
+                    }
+                    continue; // Another thread got there first: look at the node again in its new state
+                }
+                if(state == EXPANDING){
+                    for(uint32_t i : leaf.path){ arena()[i].virtualLoss.fetch_sub(1, std::memory_order_relaxed); }
+                    collisions++;
+                    return false;
+                }
+
+                index = selectChild(node);
+                leaf.position.makeMove(arena()[index].move);
+                leaf.keys.push_back(leaf.position.key);
+                enter(leaf, index);
+            }
+        }
+
+        // Creates every legal child at once, with priors from their static evaluation,
+        // and returns the value of the position itself
+        float expand(uint32_t index, const bitboard::Position &position){
+            MctsNode &node = arena()[index];
+            bitboard::Move list[bitboard::MAX_MOVES];
+            double scores[bitboard::MAX_MOVES];
+            int count = position.generateCaptures(list);
+            count += position.generateQuiets(list + count);
+
+            int legalCount = 0;
+            double bestScore = -1e9;
+            for(int i = 0; i < count; i++){
+                bitboard::Position next = position;
+                next.makeMove(list[i]);
+                if(!next.wasLegal()){ continue; }
+                list[legalCount] = list[i];
+                scores[legalCount] = -evaluate(next);
+                bestScore = std::max(bestScore, scores[legalCount]);
+                legalCount++;
+            }
+
+            if(legalCount == 0){
+                node.terminalValue = position.inCheck() ? -1.0f : 0.0f;
+                node.state.store(TERMINAL, std::memory_order_release);
+                return node.terminalValue;
+            }
+
+            float value = (float)std::tanh(evaluate(position) / EVAL_SCALE);
+            uint32_t first = arena().allocate(legalCount);
+            if(first == NO_NODE){ // Out of nodes: count the evaluation, leave the node a leaf
+                arenaFull = true;
+                stop = true;
+                node.state.store(UNEXPANDED, std::memory_order_release);
+                return value;
+            }
+
+            double total = 0;
+            for(int i = 0; i < legalCount; i++){
+                scores[i] = std::exp((scores[i] - bestScore) / PRIOR_TEMPERATURE);
+                total += scores[i];
+            }
+            for(int i = 0; i < legalCount; i++){
+                arena()[first + i].init(list[i], (float)(scores[i] / total));
+            }
+            node.firstChild = first;
+            node.childCount = (uint16_t)legalCount;
+            node.state.store(EXPANDED, std::memory_order_release);
+            return value;
+        }
+
+        void backpropagate(const Leaf &leaf){
+            float value = leaf.value;
+            for(auto it = leaf.path.rbegin(); it != leaf.path.rend(); ++it){
+                MctsNode &node = arena()[*it];
+                value = -value; // Stored for the side that moved into the node
+                node.valueSum.fetch_add((int64_t)(value * VALUE_SCALE), std::memory_order_relaxed);
+                node.visits.fetch_add(1, std::memory_order_relaxed);
+                node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Selects a batch of leaves under virtual loss, evaluates them together, then backs them up
+        void worker(uint64_t playoutLimit){
+            std::vector<Leaf> batch(batchSize);
+            while(!stop && playouts.load(std::memory_order_relaxed) < playoutLimit){
+                int count = 0;
+                for(int i = 0; i < batchSize; i++){
+                    if(selectLeaf(batch[count])){ count++; }
+                }
+                for(int i = 0; i < count; i++){
+                    if(batch[i].needsExpansion){ batch[i].value = expand(batch[i].path.back(), batch[i].position); }
+                }
+                for(int i = 0; i < count; i++){ backpropagate(batch[i]); }
+                playouts += count;
+            }
+        }
+
+        void copyNode(MctsNode &dst, MctsNode &src){
+            dst.init(src.move, src.prior);
+            dst.visits.store(src.visits.load());
+            dst.valueSum.store(src.valueSum.load());
+            dst.terminalValue = src.terminalValue;
+            uint8_t state = src.state.load();
+            dst.state.store(state == EXPANDING ? (uint8_t)UNEXPANDED : state);
+        }
+
+        // Keeps the part of the last tree that is still reachable from the new position
+        bool reuseSubtree(const bitboard::Position &position, const std::vector<uint64_t> &keys){
+            if(root == NO_NODE || keys.size() < rootKeys.size() || !std::equal(rootKeys.begin(), rootKeys.end(), keys.begin())){
+                return false;
+            }
+            uint32_t index = root;
+            bitboard::Position walk = rootPosition;
+            for(size_t i = rootKeys.size(); i < keys.size(); i++){
+                MctsNode &node = arena()[index];
+                if(node.state.load() != EXPANDED){ return false; }
+                uint32_t found = NO_NODE;
+                for(uint32_t c = node.firstChild; c < node.firstChild + node.childCount && found == NO_NODE; c++){
+                    bitboard::Position next = walk;
+                    next.makeMove(arena()[c].move);
+                    if(next.key == keys[i]){
+                        found = c;
+                        walk = next;
+                    }
+                }
+                if(found == NO_NODE){ return false; }
+                index = found;
+            }
+            if(walk.key != position.key){ return false; }
+
+            // Breadth-first copy into the spare arena, which then becomes the live one
+            NodeArena &from = arena();
+            NodeArena &to = arenas[1 - current];
+            to.reset();
+            uint32_t newRoot = to.allocate(1);
+            copyNode(to[newRoot], from[index]);
+            std::vector<std::pair<uint32_t, uint32_t>> queue = { {index, newRoot} };
+            for(size_t q = 0; q < queue.size(); q++){
+                MctsNode &src = from[queue[q].first];
+                MctsNode &dst = to[queue[q].second];
+                if(dst.state.load() != EXPANDED){ continue; }
+                uint32_t first = to.allocate(src.childCount);
+                dst.firstChild = first;
+                dst.childCount = src.childCount;
+                for(uint32_t c = 0; c < src.childCount; c++){
+                    copyNode(to[first + c], from[src.firstChild + c]);
+                    queue.push_back({src.firstChild + c, first + c});
+                }
+            }
+            from.reset();
+            current = 1 - current;
+            root = newRoot;
+            return true;
+        }
+
+        void setRoot(const bitboard::Position &position, const std::vector<uint64_t> &keys){
+            if(arenas[0].capacity != arenaCapacity){
+                arenas[0].reserve(arenaCapacity);
+                arenas[1].reserve(arenaCapacity);
+                root = NO_NODE;
+            }
+            if(!reuseSubtree(position, keys)){
+                arena().reset();
+                root = arena().allocate(1);
+                arena()[root].init(bitboard::NULL_MOVE, 1.0f);
+            }
+            reusedNodes = arena().size();
+            rootPosition = position;
+            rootKeys = keys;
+        }
+
+        bitboard::Move getBestMove(const bitboard::Position &position, const std::vector<uint64_t> &keys, uint64_t playoutLimit, int threadCount){
+            bitboard::initTables(); // Before any worker evaluates
+            auto begin = std::chrono::steady_clock::now();
+            setRoot(position, keys);
+            playouts = 0;
+            collisions = 0;
+            stop = false;
+            arenaFull = false;
+
+            MctsNode &rootNode = arena()[root];
+            if(rootNode.state.load() == UNEXPANDED){
+                rootNode.state = EXPANDING;
+                expand(root, rootPosition);
+            }
+
+            if(rootNode.state.load() == EXPANDED){
+                std::vector<std::thread> workers;
+                for(int i = 0; i < std::max(threadCount, 1); i++){
+                    workers.emplace_back(&MctsSearch::worker, this, playoutLimit);
+                }
+                for(std::thread &t : workers){ t.join(); }
+            }
+            lastSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if(arenaFull){
+                std::cerr << "---> MCTS arena full after " << playouts << " of " << playoutLimit << " playouts ("
+                          << arenaCapacity << " nodes), search cut short\n";
+            }
+
+            bitboard::Move bestMove = bitboard::NULL_MOVE;
+            uint32_t bestVisits = 0;
+            for(uint32_t i = rootNode.firstChild; i < rootNode.firstChild + rootNode.childCount; i++){
+                if(bestMove == bitboard::NULL_MOVE || arena()[i].visits > bestVisits){
+                    bestVisits = arena()[i].visits;
+                    bestMove = arena()[i].move;
+                }
+            }
+            return bestMove;
+        }
+
+        void printStats() {
+            uint32_t nodes = arena().size();
+            std::cout << "Playouts: " << playouts << "\n"
+                      << "Duration: " << lastSeconds << " second\n"
+                      << "Playouts/second: " << (uint64_t)(playouts / std::max(lastSeconds, 1e-9)) << "\n"
+                      << "Collisions: " << collisions << "\n"
+                      << "Tree Nodes: " << nodes << " (" << reusedNodes << " reused" << (arenaFull ? ", arena full" : "") << ")\n"
+                      << "Memory/node: " << sizeof(MctsNode) << " bytes\n"
+                      << "Tree Memory: " << (double)nodes * sizeof(MctsNode) / (1024 * 1024) << " MB of "
+                      << 2.0 * arenaCapacity * sizeof(MctsNode) / (1024 * 1024) << " MB reserved\n";
+        }
+    };
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include "bitboard.hpp"
+
+namespace chess
+{
+    enum class PickStage{
+        TT_MOVE,
+        GENERATE_CAPTURES,
+        CAPTURES,
+        KILLERS,
+        GENERATE_QUIETS,
+        QUIETS,
+        DONE
+    };
+
+    // Hands out moves one at a time, generating each group only when the previous
+    // one is exhausted: hash move, captures (MVV-LVA), killers, then quiet moves.
+    // Moves are pseudo-legal, legality is checked by the caller after making them.
+    struct MovePicker{
+        static bool staged;                 // false: generate and legality-check everything up front
+        static thread_local uint64_t captureGenerations;
+        static thread_local uint64_t quietGenerations;
+        static thread_local uint64_t movesGenerated;
+
+        const bitboard::Position &pos;
+        bitboard::Move ttMove;
+        bitboard::Move killers[2];
+        PickStage stage = PickStage::TT_MOVE;
+
+        bitboard::Move captures[bitboard::MAX_MOVES];
+        int captureScores[bitboard::MAX_MOVES];
+        int captureCount = 0, captureIndex = 0;
+        bitboard::Move quiets[bitboard::MAX_MOVES];
+        int quietCount = 0, quietIndex = 0;
+        int killerIndex = 0;
+        bool capturesReady = false, quietsReady = false;
+
+        MovePicker(const bitboard::Position &pos, bitboard::Move ttMove, const bitboard::Move *killerMoves) : pos(pos), ttMove(ttMove){
+            killers[0] = killerMoves ? killerMoves[0] : bitboard::NULL_MOVE;
+            killers[1] = killerMoves ? killerMoves[1] : bitboard::NULL_MOVE;
+            if (!staged) {
+                generateCaptures();
+                generateQuiets();
+                captureCount = keepLegal(captures, captureScores, captureCount);
+                quietCount = keepLegal(quiets, nullptr, quietCount);
+            }
+        }
+
+        void generateCaptures(){
+            if (capturesReady) { return; }
+            captureCount = pos.generateCaptures(captures);
+            for (int i = 0; i < captureCount; i++) {
+                bitboard::Move m = captures[i];
+                int victim = bitboard::moveFlag(m) == bitboard::EP_CAPTURE ? PAWN : PIECE_TYPE(pos.squares[bitboard::moveTo(m)]);
+                int attacker = PIECE_TYPE(pos.squares[bitboard::moveFrom(m)]);
+                captureScores[i] = (bitboard::isCapture(m) ? 10 * (victim + 1) : 0) - attacker
+                                 + (bitboard::isPromotion(m) ? 10 * bitboard::promotionType(m) : 0);
+            }
+            captureGenerations++;
+            movesGenerated += captureCount;
+            capturesReady = true;
+        }
+
+        void generateQuiets(){
+            if (quietsReady) { return; }
+            quietCount = pos.generateQuiets(quiets);
+            quietGenerations++;
+            movesGenerated += quietCount;
+            quietsReady = true;
+        }
+
+        int keepLegal(bitboard::Move *moves, int *scores, int count) const{
+            int kept = 0;
+            for (int i = 0; i < count; i++) {
+                bitboard::Position next = pos;
+                next.makeMove(moves[i]);
+                if (!next.wasLegal()) { continue; }
+                if (scores) { scores[kept] = scores[i]; }
+                moves[kept++] = moves[i];
+            }
+            return kept;
+        }
+
+        bool isKiller(bitboard::Move m) const{ return m == killers[0] || m == killers[1]; }
+
+        bitboard::Move next(){
+            switch (stage) {
+                case PickStage::TT_MOVE:
+                    stage = PickStage::GENERATE_CAPTURES;
+                    if (pos.isPseudoLegal(ttMove)) { return ttMove; }
+                    // fall through
+                case PickStage::GENERATE_CAPTURES:
+                    generateCaptures();
+                    stage = PickStage::CAPTURES;
+                    // fall through
+                case PickStage::CAPTURES:
+                    while (captureIndex < captureCount) {
+                        // Selection sort, one step per call: cut nodes never sort the whole list
+                        int best = captureIndex;
+                        for (int i = captureIndex + 1; i < captureCount; i++) {
+                            if (captureScores[i] > captureScores[best]) { best = i; }
+                        }
+                        std::swap(captures[captureIndex], captures[best]);
+                        std::swap(captureScores[captureIndex], captureScores[best]);
+                        bitboard::Move m = captures[captureIndex++];
+                        if (m != ttMove) { return m; }
+                    }
+                    stage = PickStage::KILLERS;
+                    // fall through
+                case PickStage::KILLERS:
+                    while (killerIndex < 2) {
+                        bitboard::Move m = killers[killerIndex++];
+                        if (m != ttMove && bitboard::isQuiet(m) && pos.isPseudoLegal(m)) { return m; }
+                    }
+                    stage = PickStage::GENERATE_QUIETS;
+                    // fall through
+                case PickStage::GENERATE_QUIETS:
+                    generateQuiets();
+                    stage = PickStage::QUIETS;
+                    // fall through
+                case PickStage::QUIETS:
+                    while (quietIndex < quietCount) {
+                        bitboard::Move m = quiets[quietIndex++];
+                        if (m != ttMove && !isKiller(m)) { return m; }
+                    }
+                    stage = PickStage::DONE;
+                    // fall through
+                case PickStage::DONE:
+                    break;
+            }
+            return bitboard::NULL_MOVE;
+        }
+    };
+
+    bool MovePicker::staged = true;
+    thread_local uint64_t MovePicker::captureGenerations = 0;
+    thread_local uint64_t MovePicker::quietGenerations = 0;
+    thread_local uint64_t MovePicker::movesGenerated = 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include "bitboard.hpp"
+
+namespace chess
+{
+    const std::string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    struct PgnGame{
+        std::map<std::string, std::string> tags;
+        std::string startFen = START_FEN;
+        std::vector<bitboard::Move> moves;
+        std::string result = "*";
+    };
+
+    bool isPgnResult(const std::string &token){
+        return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+    }
+
+    // True for a line holding a FEN/EPD position rather than PGN
+    bool isFenLine(const std::string &line){
+        std::string placement = line.substr(0, line.find(' '));
+        return std::count(placement.begin(), placement.end(), '/') == 7;
+    }
+
+    // Parses the tag pairs and movetext of one game. Comments, variations and NAGs are skipped.
+    // An illegal move ends the game there with a warning, the moves before it are kept.
+    PgnGame parsePgn(const std::string &text){
+        PgnGame game;
+        std::string movetext;
+        std::istringstream lines(text);
+        for (std::string line; std::getline(lines, line); ) {
+            size_t open = line.find('[');
+            if (open == std::string::npos || line.find_first_not_of(" \t") != open) {
+                movetext += line + "\n";
+                continue;
+            }
+            size_t nameEnd = line.find(' ', open);
+            size_t valueBegin = line.find('"', nameEnd);
+            size_t valueEnd = line.rfind('"');
+            if (nameEnd == std::string::npos || valueBegin == std::string::npos || valueEnd <= valueBegin) { continue; }
+            game.tags[line.substr(open + 1, nameEnd - open - 1)] = line.substr(valueBegin + 1, valueEnd - valueBegin - 1);
+        }
+        if (game.tags.count("FEN")) { game.startFen = game.tags["FEN"]; }
+
+        bitboard::Position position(game.startFen);
+        std::string token;
+        int variationDepth = 0;
+        bool illegalMove = false;
+        auto flush = [&]() {
+            if (token.empty()) { return; }
+            if (isPgnResult(token)) { game.result = token; token.clear(); return; }
+            size_t begin = token.find_first_not_of("0123456789.");   // Move numbers, also glued to the move
+            std::string san = begin == std::string::npos ? "" : token.substr(begin);
+            token.clear();
+            if (san.empty() || san[0] == '$' || illegalMove) { return; }
+            bitboard::Move move = position.parseMove(san);
+            if (move == bitboard::NULL_MOVE) {
+                std::cerr << "---> Illegal move " << san << " in " << position.fen() << ", game cut off there\n";
+                illegalMove = true;
+                return;
+            }
+            game.moves.push_back(move);
+            position.makeMove(move);
+        };
+        for (size_t i = 0; i < movetext.size(); i++) {
+            char ch = movetext[i];
+            if (ch == '{') { flush(); i = std::min(movetext.find('}', i), movetext.size()); }
+            else if (ch == ';') { flush(); i = std::min(movetext.find('\n', i), movetext.size()); }
+            else if (ch == '(') { flush(); variationDepth++; }
+            else if (ch == ')') { variationDepth = std::max(0, variationDepth - 1); token.clear(); }
+            else if (variationDepth > 0) { continue; }
+            else if (isspace((unsigned char)ch)) { flush(); }
+            else { token += ch; }
+        }
+        flush();
+        return game;
+    }
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include "search.hpp"
+
+namespace chess
+{
+    struct GameStats{
+        uint64_t searches = 0;
+        double totalLatency = 0;        // Submit to result, seconds
+        double maxLatency = 0;
+        double totalQueueWait = 0;      // Submit to the main thread starting
+        double threadSeconds = 0;       // Worker time spent on the game, helpers included
+        int peakThreads = 0;
+    };
+
+    // Shares one pool of search threads, sized by a core budget, between the games played at once.
+    // Every search gets a main thread; spare cores become helper threads (lazy SMP over the shared
+    // hash table), weighted towards games with the least time per move. Allocations are recomputed
+    // whenever a search starts or finishes, and helpers above a game's new share are stopped.
+    struct CoreScheduler{
+        struct Job{
+            std::string gameId;
+            GameHistory game;
+            SearchLimits limits;
+            double weight;
+            std::chrono::steady_clock::time_point submitted, started;
+            bool mainTaken = false, finished = false;
+            int allocated = 0;
+            int running = 0;                // Main and helper threads working on it, stopping ones included
+            int peakThreads = 0;
+            int helpersStarted = 0;
+            std::vector<std::shared_ptr<std::atomic<bool>>> helperStops; // Of the running helpers, oldest first
+            double threadSeconds = 0;
+            std::shared_ptr<TranspositionTable> table;  // The game's hash file, null for the shared table
+            SearchResult result;
+            SearchResult deepestHelper;     // Helper result with the deepest completed iteration
+
+            Job(const std::string &gameId, const GameHistory &game) : gameId(gameId), game(game){}
+        };
+
+        int budget = 1;
+        std::mutex mutex;
+        std::condition_variable workAvailable, jobDone;
+        std::vector<Job*> jobs;             // Submitted and not yet returned, oldest first
+        std::vector<std::thread> workers;
+        bool shuttingDown = false;
+        std::map<std::string, GameStats> stats;
+        std::chrono::steady_clock::time_point statsBegin = std::chrono::steady_clock::now();
+        double busySeconds = 0;
+
+        explicit CoreScheduler(int cores){ start(cores); }
+        ~CoreScheduler(){ stop(); }
+
+        void start(int cores){
+            budget = std::max(1, cores);
+            shuttingDown = false;
+            for(int i = 0; i < budget; i++){ workers.emplace_back(&CoreScheduler::workerLoop, this); }
+        }
+
+        void stop(){
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                shuttingDown = true;
+            }
+            workAvailable.notify_all();
+            for(std::thread &worker : workers){ worker.join(); }
+            workers.clear();
+        }
+
+        // Waits for the searches in progress, then resizes the pool
+        void setBudget(int cores){
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobDone.wait(lock, [&]{ return jobs.empty(); });
+            }
+            stop();
+            start(cores);
+        }
+
+        // Called with the mutex held
+        void rebalance(){
+            std::vector<Job*> live;
+            for(Job *job : jobs){
+                job->allocated = 0;
+                if(!job->finished){ live.push_back(job); }
+            }
+            // One thread per search while cores last, in submission order
+            int spare = budget;
+            double totalWeight = 0;
+            std::vector<Job*> served;
+            for(Job *job : live){
+                if(spare == 0){ break; }
+                job->allocated = 1;
+                spare--;
+                totalWeight += job->weight;
+                served.push_back(job);
+            }
+            // The rest by weight, largest remainder first
+            std::vector<std::pair<double, Job*>> remainders;
+            int given = 0;
+            for(Job *job : served){
+                double share = spare * job->weight / totalWeight;
+                int whole = (int)std::floor(share);
+                job->allocated += whole;
+                given += whole;
+                remainders.push_back({share - whole, job});
+            }
+            std::stable_sort(remainders.begin(), remainders.end(), [](const std::pair<double, Job*> &a, const std::pair<double, Job*> &b){
+                return a.first > b.first;
+            });
+            for(int i = 0; i < spare - given && i < (int)remainders.size(); i++){ remainders[i].second->allocated++; }
+            // Newest helpers give their cores back first
+            for(Job *job : live){
+                int threads = (job->mainTaken ? 1 : 0) + (int)job->helperStops.size();
+                for(int i = (int)job->helperStops.size() - 1; i >= 0 && threads > std::max(job->allocated, 1); i--){
+                    job->helperStops[i]->store(true, std::memory_order_relaxed);
+                    job->helperStops.erase(job->helperStops.begin() + i);
+                    threads--;
+                }
+            }
+        }
+
+        // A search waiting for its main thread, else the one furthest below its allocation
+        Job* pickJob(){
+            for(Job *job : jobs){
+                if(!job->mainTaken && job->allocated > 0){ return job; }
+            }
+            Job *best = nullptr;
+            for(Job *job : jobs){
+                if(job->finished || !job->mainTaken || job->running >= job->allocated){ continue; }
+                if(!best || job->allocated - job->running > best->allocated - best->running){ best = job; }
+            }
+            return best;
+        }
+
+        void workerLoop(){
+            blindSearch context;            // Killers and key stack of this thread, hash table of the game
+            std::unique_lock<std::mutex> lock(mutex);
+            while(true){
+                Job *job = nullptr;
+                workAvailable.wait(lock, [&]{ return shuttingDown || (job = pickJob()) != nullptr; });
+                if(shuttingDown){ return; }
+
+                bool isMain = !job->mainTaken;
+                SearchLimits limits = job->limits;
+                context.table = job->table ? job->table.get() : &tt;
+                std::shared_ptr<std::atomic<bool>> helperStop;
+                if(isMain){
+                    job->mainTaken = true;
+                    job->started = std::chrono::steady_clock::now();
+                    context.stopSignal = nullptr;
+                }
+                else{ // Runs until the main thread is done, sharing scores with it through the hash table
+                    helperStop = std::make_shared<std::atomic<bool>>(false);
+                    job->helperStops.push_back(helperStop);
+                    limits.firstDepth = 1 + (++job->helpersStarted) % 2;
+                    limits.depth = MAX_PLY - 1;
+                    limits.nodes = 0;
+                    limits.seconds = 0;
+                    limits.multiPv = 1;
+                    context.stopSignal = helperStop.get();
+                }
+                job->running++;
+                job->peakThreads = std::max(job->peakThreads, job->running);
+                lock.unlock();
+
+                auto begin = std::chrono::steady_clock::now();
+                SearchResult result = context.search(job->game, limits);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+                lock.lock();
+                busySeconds += seconds;
+                job->threadSeconds += seconds;
+                job->running--;
+                if(isMain){
+                    job->result = std::move(result);
+                    job->finished = true;
+                    for(auto &stop : job->helperStops){ stop->store(true, std::memory_order_relaxed); }
+                    job->helperStops.clear();
+                }
+                else{
+                    job->helperStops.erase(std::remove(job->helperStops.begin(), job->helperStops.end(), helperStop), job->helperStops.end());
+                    if(result.depth > job->deepestHelper.depth){ job->deepestHelper = std::move(result); }
+                }
+                if(job->finished && job->running == 0){ jobDone.notify_all(); }
+                rebalance();
+                workAvailable.notify_all();
+            }
+        }
+
+        // Blocks until the search is done. clockSeconds <= 0 searches to the given depth instead.
+        SearchResult search(const std::string &gameId, const GameHistory &game, double clockSeconds, double incrementSeconds,
+                            int depth = MAX_SEARCH_DEPTH){
+            Job job(gameId, game);
+            double seconds = moveTime(clockSeconds, incrementSeconds);
+            job.limits.depth = seconds > 0 ? MAX_PLY - 1 : depth;
+            job.limits.seconds = seconds;
+            job.weight = 1 / std::max(seconds > 0 ? seconds : 10.0, 0.01);
+            job.table = hashFiles.table(gameId);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            job.submitted = std::chrono::steady_clock::now();
+            jobs.push_back(&job);
+            rebalance();
+            workAvailable.notify_all();
+            jobDone.wait(lock, [&]{ return job.finished && job.running == 0; });
+            jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+            // Helpers start deeper and stop only with the main thread, so one may have completed more
+            if(job.deepestHelper.depth > job.result.depth){ job.result = std::move(job.deepestHelper); }
+
+            auto end = std::chrono::steady_clock::now();
+            GameStats &gameStats = stats[gameId];
+            double latency = std::chrono::duration<double>(end - job.submitted).count();
+            gameStats.searches++;
+            gameStats.totalLatency += latency;
+            gameStats.maxLatency = std::max(gameStats.maxLatency, latency);
+            gameStats.totalQueueWait += std::chrono::duration<double>(job.started - job.submitted).count();
+            gameStats.threadSeconds += job.threadSeconds;
+            gameStats.peakThreads = std::max(gameStats.peakThreads, job.peakThreads);
+            rebalance();
+            workAvailable.notify_all();
+            jobDone.notify_all();
+            return job.result;
+        }
+
+        // {"budget":..,"utilisation":..,"games":{"<id>":{...}}}, utilisation is busy thread time over budget * wall time
+        std::string statsJson(){
+            std::lock_guard<std::mutex> lock(mutex);
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - statsBegin).count();
+            std::ostringstream out;
+            out << "{\"budget\":" << budget
+                << ",\"active\":" << jobs.size()
+                << ",\"utilisation\":" << busySeconds / std::max(budget * wall, 1e-9)
+                << ",\"games\":{";
+            bool first = true;
+            for(const auto &entry : stats){
+                const GameStats &game = entry.second;
+                out << (first ? "" : ",") << "\"" << entry.first << "\":{"
+                    << "\"searches\":" << game.searches
+                    << ",\"avgLatency\":" << game.totalLatency / game.searches
+                    << ",\"maxLatency\":" << game.maxLatency
+                    << ",\"avgQueueWait\":" << game.totalQueueWait / game.searches
+                    << ",\"threadSeconds\":" << game.threadSeconds
+                    << ",\"peakThreads\":" << game.peakThreads << "}";
+                first = false;
+            }
+            out << "}}";
+            return out.str();
+        }
+
+        void resetStats(){
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.clear();
+            busySeconds = 0;
+            statsBegin = std::chrono::steady_clock::now();
+        }
+    };
+
+    // Process-wide scheduler used by the C API, one thread per core until told otherwise
+    CoreScheduler& coreScheduler(){
+        static CoreScheduler scheduler(std::max(1u, std::thread::hardware_concurrency()));
+        return scheduler;
+    }
+}
@@ -0,0 +1,617 @@
+#pragma once
+#include <iostream>
+#include <unistd.h>
+#include <limits.h>
+#include <string>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <ctime>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include "eval.hpp"
+#include "bitboard.hpp"
+#include "tt.hpp"
+#include "movepick.hpp"
+#include "mcts.hpp"
+
+namespace chess
+{
+    enum class Player{
+        WHITE_PLAYER,
+        BLACK_PLAYER
+    };
+
+    enum class GameState{
+        ONGOING,
+        WIN,
+        LOSE,
+        DRAW
+    };
+
+    std::string getCurrentTimeStamp() {
+        auto t = std::time(nullptr);
+        auto tm = *std::localtime(&t);
+        std::ostringstream oss;
+        oss << std::put_time(&tm, "%d.%m.%Y_%H:%M:%S");
+        return oss.str();
+    }
+    
+    const std::string timeStamp = getCurrentTimeStamp();
+    const int MAX_SEARCH_DEPTH = 3;       // Default depth of the bot's searches
+    const int BENCH_DEPTH = 5;
+    const int MAX_PLY = 64;
+    const int64_t WIN_SCORE = 1000000000;
+    const int64_t DRAW_SCORE = 0;
+    const int64_t LOST_SCORE = -1000000000;
+    const int64_t INFINITE_SCORE = WIN_SCORE + 1;
+    const int64_t MATE_BOUND = WIN_SCORE - MAX_PLY; // Scores beyond this are forced mates
+    const bool PRINT_SEARCH_TREE = false; // Writes every searched node to ST/, very slow
+    thread_local Player player;
+    TranspositionTable tt;
+    HashFiles hashFiles;                  // Per-game tables in files, see open_hash_file
+
+    // Each technique can be switched off on its own to measure what it buys
+    struct SelectiveSearch{
+        bool nullMovePruning = true;
+        bool nullMoveVerification = true;
+        bool lateMoveReductions = true;
+        bool reverseFutilityPruning = true;
+        bool futilityPruning = true;
+        bool mateDistancePruning = true;
+    };
+    SelectiveSearch selective;
+
+    int64_t mateIn(int ply){ return WIN_SCORE - ply; }
+    int64_t matedIn(int ply){ return LOST_SCORE + ply; }
+
+    // The hash table keeps mates counted from the stored position, so they hold at any ply
+    int64_t scoreToTable(int64_t score, int ply){
+        return score >= MATE_BOUND ? score + ply : score <= -MATE_BOUND ? score - ply : score;
+    }
+
+    int64_t scoreFromTable(int64_t score, int ply){
+        return score >= MATE_BOUND ? score - ply : score <= -MATE_BOUND ? score + ply : score;
+    }
+
+    // Score for the side to move
+    template<int Us>
+    int evaluate(const bitboard::Position &position){ return eval::evalPieces<Us>(position.pieces); }
+
+    int evaluate(const bitboard::Position &position){
+        return position.side == WHITE ? evaluate<WHITE>(position) : evaluate<BLACK>(position);
+    }
+
+    // Share of the remaining clock to spend on this move, 0 when the clock is unknown
+    double moveTime(double clockSeconds, double incrementSeconds){
+        if(clockSeconds <= 0){ return 0; }
+        return std::min(clockSeconds * 0.5, clockSeconds / 30 + incrementSeconds * 0.75);
+    }
+
+    int depthToBeSearched(const float secondsLeftToMakeMove){
+        throw std::runtime_error("Not implemented yet");
+    }
+
+    // The game so far: start position plus the moves played from it
+    struct GameHistory{
+        bitboard::Position position;        // Position after the last move
+        std::vector<uint64_t> keys;         // Zobrist key of every position of the game, current one last
+
+        GameHistory(const std::string &startFen, const std::vector<std::string> &moves = {}) : position(startFen){
+            keys.push_back(position.key);
+            for(const std::string &move : moves){ play(move); }
+        }
+
+        void play(const std::string &uciMove){
+            bitboard::Move move = position.parseUciMove(uciMove);
+            if(move == bitboard::NULL_MOVE){
+                throw std::runtime_error("---> Illegal move " + uciMove + " in " + position.fen());
+            }
+            play(move);
+        }
+
+        void play(bitboard::Move move){
+            position.makeMove(move);
+            keys.push_back(position.key);
+        }
+    };
+
+    // UCI score: "cp <centipawns>" or "mate <moves>", negative when the side to move is mated
+    std::string scoreToUci(int64_t score){
+        if(score >= MATE_BOUND){ return "mate " + std::to_string((WIN_SCORE - score + 1) / 2); }
+        if(score <= -MATE_BOUND){ return "mate " + std::to_string(-(WIN_SCORE + score) / 2); }
+        return "cp " + std::to_string(score);
+    }
+
+    std::vector<std::string> splitMoves(const std::string &moves){
+        std::istringstream ss(moves);
+        std::vector<std::string> res;
+        for(std::string move; ss >> move; ){ res.push_back(move); }
+        return res;
+    }
+
+    struct boardState{
+        static thread_local uint64_t bsCounter;
+        static int64_t bestScoresForDepth[MAX_SEARCH_DEPTH] ; // index: depth, value score
+
+        bitboard::Position position;
+        bitboard::Move prevMoveMade = bitboard::NULL_MOVE;
+        bitboard::Move bestMove = bitboard::NULL_MOVE;
+        
+        Player turn;
+        boardState* parentBS;
+        GameState gameState = GameState::ONGOING;
+        int64_t evaluationScore = -123456789;
+        signed short depth = -1;
+        int pliesFromNull = 0;
+        bool worthSearching = true;
+
+        boardState(const bitboard::Position &position, int depth) : position(position), parentBS(nullptr), depth(depth){
+            bsCounter++;
+            pliesFromNull = position.halfmoveClock;
+            turn = position.side == WHITE ? Player::WHITE_PLAYER : Player::BLACK_PLAYER;
+            if(depth == 0){ chess::player = turn; }
+        }
+
+        // Child node; the move is only pseudo-legal, check isLegal() before searching it.
+        // NULL_MOVE passes the turn.
+        boardState(boardState* parentBS, bitboard::Move moveMade) : position(parentBS->position), prevMoveMade(moveMade), parentBS(parentBS), depth(parentBS->depth + 1){
+            bsCounter++;
+            if(moveMade == bitboard::NULL_MOVE){ position.makeNullMove(); }
+            else{
+                position.makeMove(moveMade);
+                pliesFromNull = parentBS->pliesFromNull + 1;
+            }
+            turn = position.side == WHITE ? Player::WHITE_PLAYER : Player::BLACK_PLAYER;
+        }
+
+        bool isLegal() const{ return position.wasLegal(); }
+
+        void printToTextFile() {
+            std::string fileName = "ST/output_" + timeStamp + ".txt";
+            std::ofstream outFile(fileName, std::ios::app);
+            if (outFile.is_open()) {
+                // Add title line if the file is empty
+                if (outFile.tellp() == 0) {
+                    outFile << "ParentBoard\tFEN Board\tTurn\tGame State\tEvaluation Score\tDepth\tMoveMade\n";
+                }
+                outFile << (parentBS ? "0x" + std::to_string(reinterpret_cast<uintptr_t>(parentBS)) : "0x0000000000") << "\t"
+                        << "\"" << position.fen() << "\"" << "\t"
+                        << (turn == Player::WHITE_PLAYER ? "WHITE" : "BLACK") << "\t"
+                        << (gameState == GameState::WIN ? "WIN" : 
+                            gameState == GameState::DRAW ? "DRAW" : 
+                            gameState == GameState::LOSE ? "LOSE" : "ONGOING") << "\t"
+                        << evaluationScore << "\t"
+                        << depth << "\t"
+                        << bitboard::moveToUci(prevMoveMade) << "\n";
+                outFile.close();
+            } else {
+                std::cerr << "Unable to open file" << std::endl;
+            }
+        }
+
+        bool isBranchWorthSearching(){
+            throw std::runtime_error("Not implemented");
+            return 0;
+        }
+
+        bool isTurnMine(){ return turn == chess::player; }
+
+    };
+    
+    // Definitions for static variables
+    thread_local uint64_t boardState::bsCounter = 0;
+    int64_t boardState::bestScoresForDepth[MAX_SEARCH_DEPTH] = { INT64_MIN };
+
+    void stampTextFile(std::chrono::system_clock::time_point begin, std::chrono::system_clock::time_point end) {
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+        std::time_t begin_time_t = std::chrono::system_clock::to_time_t(begin);
+        std::time_t end_time_t = std::chrono::system_clock::to_time_t(end);
+        std::tm begin_local_time = *std::localtime(&begin_time_t);
+        std::tm end_local_time = *std::localtime(&end_time_t);
+        std::string fileName = "ST/output_" + chess::timeStamp + ".txt";
+        std::ofstream outFile(fileName, std::ios::app);
+        if (outFile.is_open()) {
+            outFile << "Begin Timestamp: " << std::put_time(&begin_local_time, "%H:%M:%S") << "." 
+                    << std::setw(6) << std::setfill('0') << (std::chrono::duration_cast<std::chrono::microseconds>(begin.time_since_epoch()).count() % 1000000) << "\n"
+                    << "End Timestamp: " << std::put_time(&end_local_time, "%H:%M:%S") << "." 
+                    << std::setw(6) << std::setfill('0') << (std::chrono::duration_cast<std::chrono::microseconds>(end.time_since_epoch()).count() % 1000000) << "\n"
+                    << "Duration: " << (float)duration/1000000 << " second\n"
+                    << "Board State Counter: " << boardState::bsCounter << "\n"
+                    << "Max Search Depth: " << MAX_SEARCH_DEPTH << "\n";
+            outFile.close();
+        } else {
+            std::cerr << "Unable to open file" << std::endl;
+        }
+        std::cout << "Duration: " << (float)duration/1000000 << " second\n";
+        std::cout << "Games Searched: " << boardState::bsCounter << "\n";
+    }
+    
+
+    // Limits of one search, zero means unlimited
+    struct SearchLimits{
+        int depth = MAX_SEARCH_DEPTH;
+        uint64_t nodes = 0;
+        double seconds = 0;
+        int multiPv = 1;                // Number of best root moves to score exactly
+        int firstDepth = 1;             // Helper threads start deeper to spread out
+    };
+
+    struct SearchLine{
+        int64_t score;
+        std::vector<bitboard::Move> pv;
+    };
+
+    struct SearchIteration{
+        int depth;
+        bitboard::Move bestMove;
+        int64_t score;
+        uint64_t nodes;
+        double seconds;
+    };
+
+    struct SearchResult{
+        bitboard::Move bestMove = bitboard::NULL_MOVE;
+        int64_t score = 0;
+        std::vector<bitboard::Move> pv;
+        int depth = 0;                  // Last completed iteration
+        uint64_t nodes = 0;
+        double seconds = 0;
+        std::vector<SearchIteration> iterations;
+        std::vector<SearchLine> lines;  // Best first, one per MultiPV line
+    };
+
+    // One search context: several can run on different threads, each with its own
+    // killers and key stack. They share the global hash table unless given another one.
+    struct blindSearch{
+
+        bitboard::Move killers[MAX_PLY][2];
+        std::vector<uint64_t> keyStack; // Game history followed by the current search path
+        TranspositionTable *table = &chess::tt;
+        SearchLimits limits;
+        std::chrono::steady_clock::time_point searchBegin;
+        uint64_t nodes = 0;
+        bool stopSearch = false;
+        const std::atomic<bool> *stopSignal = nullptr; // Set from another thread to end the search early
+        bitboard::Move pv[MAX_PLY][MAX_PLY];   // Triangular: pv[ply] is the line from that ply on
+        int pvLength[MAX_PLY];
+        std::vector<bitboard::Move> excludedRootMoves; // Moves of the MultiPV lines already found
+
+        static void updateBestScoresForDepth(){
+            // Check my notebook
+        }
+
+        void updatePv(int ply, bitboard::Move move){
+            pv[ply][0] = move;
+            int childLength = ply + 1 < MAX_PLY ? pvLength[ply + 1] : 0;
+            std::copy(pv[ply + 1], pv[ply + 1] + childLength, pv[ply] + 1);
+            pvLength[ply] = childLength + 1;
+        }
+
+        void storeKiller(int ply, bitboard::Move move){
+            if(killers[ply][0] != move){
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = move;
+            }
+        }
+
+        bool isDraw(const boardState* board){
+            int reversible = std::min<int>(board->position.halfmoveClock, board->pliesFromNull);
+            return bitboard::isDraw(board->position, [this](int i){ return keyStack[i]; }, (int)keyStack.size() - 1, reversible);
+        }
+
+        static const int REVERSE_FUTILITY_DEPTH = 6;
+        static const int REVERSE_FUTILITY_MARGIN = 120; // per ply of remaining depth
+        static const int FUTILITY_DEPTH = 3;
+        static const int FUTILITY_MARGIN = 200;         // per ply of remaining depth
+        static const int NULL_MOVE_DEPTH = 3;
+        static const int NULL_MOVE_VERIFICATION_DEPTH = 6;
+        static const int LMR_DEPTH = 3;
+        static const int LMR_MOVE_COUNT = 3;             // moves searched at full depth before reducing
+
+        static int reductions[MAX_PLY][bitboard::MAX_MOVES]; // [remaining depth][move number]
+
+        static bool initReductions(){
+            for(int depth = 1; depth < MAX_PLY; depth++){
+                for(int moveCount = 1; moveCount < bitboard::MAX_MOVES; moveCount++){
+                    reductions[depth][moveCount] = (int)(0.75 + std::log(depth) * std::log(moveCount) / 2.25);
+                }
+            }
+            return true;
+        }
+
+        double elapsedSeconds() const{
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - searchBegin).count();
+        }
+
+        void checkLimits(){
+            if(stopSignal && stopSignal->load(std::memory_order_relaxed)){ stopSearch = true; }
+            if(limits.nodes && nodes >= limits.nodes){ stopSearch = true; }
+            if(limits.seconds > 0 && (nodes & 1023) == 0 && elapsedSeconds() >= limits.seconds){ stopSearch = true; }
+        }
+
+        int64_t searchChild(boardState &subBS, int64_t alpha, int64_t beta, int depth){
+            keyStack.push_back(subBS.position.key);
+            getBestMoveHelper(&subBS, alpha, beta, depth, subBS.prevMoveMade != bitboard::NULL_MOVE); // No two null moves in a row
+            keyStack.pop_back();
+            return -subBS.evaluationScore;
+        }
+
+        // Negamax: evaluationScore is from the point of view of the side to move at that node
+        void getBestMoveHelper(boardState* board, int64_t alpha, int64_t beta, int depth, bool allowNullMove = true){
+            if(board->position.side == WHITE){ searchNode<WHITE>(board, alpha, beta, depth, allowNullMove); }
+            else{ searchNode<BLACK>(board, alpha, beta, depth, allowNullMove); }
+        }
+
+        // One node for side to move Us: check, evaluation and legality tests resolve the color at compile time
+        template<int Us>
+        void searchNode(boardState* board, int64_t alpha, int64_t beta, int depth, bool allowNullMove){
+
+            const bitboard::Position &position = board->position;
+            int ply = board->depth;
+            nodes++;
+            pvLength[ply] = 0;
+            checkLimits();
+            if(stopSearch){ // Whatever is left in this subtree is thrown away by the caller
+                return;
+            }
+            else if(ply > 0 && isDraw(board)){ // Twofold repetition is enough inside the search
+                board->gameState = GameState::DRAW;
+                board->evaluationScore = DRAW_SCORE;
+                return;
+            }
+            else if(depth <= 0 || ply >= MAX_PLY - 1){
+                board->evaluationScore = evaluate<Us>(position);
+                return;
+            }
+
+            if(selective.mateDistancePruning && ply > 0){ // No line can beat a mate that is already shorter
+                alpha = std::max(alpha, matedIn(ply));
+                beta = std::min(beta, mateIn(ply + 1));
+                if(alpha >= beta){
+                    board->evaluationScore = alpha;
+                    return;
+                }
+            }
+
+            // A deep enough entry whose bound settles a null window ends the node. PV nodes (and the
+            // root) always search, so their line reaches the horizon.
+            TTEntry entry;
+            bool hashHit = table->probe(position.key, entry);
+            if(hashHit && ply > 0 && beta - alpha == 1 && entry.depth >= depth){
+                int64_t score = scoreFromTable(entry.score, ply);
+                if(entry.bound == BOUND_EXACT || (entry.bound == BOUND_LOWER && score >= beta)
+                   || (entry.bound == BOUND_UPPER && score <= alpha)){
+                    board->evaluationScore = score;
+                    return;
+                }
+            }
+            int64_t originalAlpha = alpha;
+
+            bool inCheck = position.inCheckFor<Us>();
+            int64_t staticEval = inCheck ? 0 : evaluate<Us>(position);
+            bool nonMateWindow = std::abs(beta) < MATE_BOUND;
+
+            if(selective.reverseFutilityPruning && ply > 0 && !inCheck && depth <= REVERSE_FUTILITY_DEPTH && nonMateWindow
+               && staticEval - REVERSE_FUTILITY_MARGIN * depth >= beta){
+                board->evaluationScore = staticEval;
+                return;
+            }
+
+            if(selective.nullMovePruning && allowNullMove && ply > 0 && !inCheck && depth >= NULL_MOVE_DEPTH && nonMateWindow
+               && staticEval >= beta && position.hasNonPawnMaterial(Us)){
+                int reduction = 3 + depth / 6;
+                boardState nullBS(board, bitboard::NULL_MOVE);
+                int64_t score = searchChild(nullBS, -beta, -beta + 1, depth - 1 - reduction);
+                if(score >= beta){
+                    if(score >= MATE_BOUND){ score = beta; } // Do not trust mates found after passing
+                    // Near the root, confirm with a reduced search of our own moves to guard against zugzwang
+                    bool verified = true;
+                    if(selective.nullMoveVerification && depth >= NULL_MOVE_VERIFICATION_DEPTH){
+                        searchNode<Us>(board, beta - 1, beta, depth - reduction, false);
+                        verified = board->evaluationScore >= beta;
+                    }
+                    if(verified){
+                        board->evaluationScore = score;
+                        return;
+                    }
+                }
+            }
+
+            // Moves come out lazily: hash move, captures, killers, quiets. A cutoff skips the rest.
+            MovePicker picker(position, hashHit ? entry.move : bitboard::NULL_MOVE, killers[ply]);
+
+            bool futile = selective.futilityPruning && ply > 0 && !inCheck && depth <= FUTILITY_DEPTH
+                          && std::abs(alpha) < MATE_BOUND && staticEval + FUTILITY_MARGIN * depth <= alpha;
+            int64_t bestScore = -INFINITE_SCORE;
+            board->bestMove = bitboard::NULL_MOVE;
+            int legalMoveCount = 0;
+            pvLength[ply] = 0;
+
+            for(bitboard::Move move = picker.next(); move != bitboard::NULL_MOVE; move = picker.next()){
+                if(ply == 0 && std::find(excludedRootMoves.begin(), excludedRootMoves.end(), move) != excludedRootMoves.end()){
+                    continue;
+                }
+                boardState subBS(board, move);
+                if(subBS.position.inCheckFor<Us>()){ continue; } // Left our own king attacked
+                legalMoveCount++;
+
+                bool quiet = bitboard::isQuiet(move);
+                bool givesCheck = subBS.position.inCheckFor<OTHER(Us)>();
+                if(futile && quiet && !givesCheck && legalMoveCount > 1){ continue; }
+
+                int64_t score;
+                if(selective.lateMoveReductions && quiet && !inCheck && !givesCheck && depth >= LMR_DEPTH
+                   && legalMoveCount > LMR_MOVE_COUNT){
+                    int reduction = reductions[std::min(depth, MAX_PLY - 1)][std::min(legalMoveCount, bitboard::MAX_MOVES - 1)];
+                    int reducedDepth = std::max(1, depth - 1 - reduction);
+                    score = searchChild(subBS, -alpha - 1, -alpha, reducedDepth);
+                    if(score > alpha && reducedDepth < depth - 1){ // Reduced move looks good, look again properly
+                        score = searchChild(subBS, -beta, -alpha, depth - 1);
+                    }
+                }
+                else{
+                    score = searchChild(subBS, -beta, -alpha, depth - 1);
+                }
+
+                if(score > bestScore){
+                    bestScore = score;
+                    board->bestMove = move;
+                    if(score > alpha){ updatePv(ply, move); }
+                }
+                alpha = std::max(alpha, bestScore);
+                if(alpha >= beta){
+                    if(quiet){ storeKiller(ply, move); }
+                    break;
+                }
+            }
+
+            if(stopSearch){
+                return;
+            }
+            else if(legalMoveCount == 0){
+                if(inCheck){ // Checkmated side is the one to move
+                    board->gameState = board->isTurnMine() ? GameState::LOSE : GameState::WIN;
+                    board->evaluationScore = matedIn(ply);
+                }
+                else{
+                    board->gameState = GameState::DRAW;
+                    board->evaluationScore = DRAW_SCORE;
+                }
+            }
+            else{
+                board->evaluationScore = bestScore;
+                if(ply > 0 || excludedRootMoves.empty()){ // Keep the first line's move as the root hash move
+                    Bound bound = bestScore >= beta ? BOUND_LOWER : bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+                    table->store(position.key, board->bestMove, depth, scoreToTable(bestScore, ply), bound);
+                }
+            }
+
+            if(PRINT_SEARCH_TREE){ board->printToTextFile(); }
+            
+        }
+
+        SearchResult search(const GameHistory &game, const SearchLimits &searchLimits){
+            static bool reductionsInitialized = initReductions(); // Thread-safe, once
+            (void)reductionsInitialized;
+            limits = searchLimits;
+            searchBegin = std::chrono::steady_clock::now();
+            nodes = 0;
+            stopSearch = false;
+            keyStack = game.keys;
+            std::fill(&killers[0][0], &killers[0][0] + MAX_PLY * 2, bitboard::NULL_MOVE);
+            SearchResult result;
+            table->beginSearch();
+
+            // Iterative deepening, each iteration orders the next one through the hash table.
+            // MultiPV line k is a full-window root search without the moves of lines 1..k-1,
+            // so every line gets an exact score and later lines reuse the hash of earlier ones.
+            for(int depth = std::max(1, limits.firstDepth); depth <= std::min(limits.depth, MAX_PLY - 1) && !stopSearch; depth++){
+                std::vector<SearchLine> lines;
+                excludedRootMoves.clear();
+                for(int k = 0; k < std::max(1, limits.multiPv) && !stopSearch; k++){
+                    boardState board(game.position, 0);
+                    getBestMoveHelper(&board, -INFINITE_SCORE, INFINITE_SCORE, depth);
+                    // A stopped root has no trustworthy score: interrupted children leave theirs unset
+                    if(stopSearch || board.bestMove == bitboard::NULL_MOVE){ break; } // Or no moves left at the root
+                    SearchLine line{board.evaluationScore, std::vector<bitboard::Move>(pv[0], pv[0] + pvLength[0])};
+                    if(line.pv.empty() || line.pv[0] != board.bestMove){ line.pv = {board.bestMove}; }
+                    lines.push_back(line);
+                    excludedRootMoves.push_back(board.bestMove);
+                }
+                excludedRootMoves.clear();
+                if(stopSearch || lines.empty()){ break; } // Interrupted, or mate or stalemate at the root
+                // Lines are found best first, but a deeper look can still reorder equal bounds
+                std::stable_sort(lines.begin(), lines.end(), [](const SearchLine &a, const SearchLine &b){ return a.score > b.score; });
+                result.lines = lines;
+                result.bestMove = lines[0].pv[0];
+                result.score = lines[0].score;
+                result.pv = lines[0].pv;
+                result.depth = depth;
+                result.iterations.push_back({depth, result.bestMove, result.score, nodes, elapsedSeconds()});
+                bool allMates = std::all_of(lines.begin(), lines.end(), [&](const SearchLine &line){
+                    return WIN_SCORE - std::abs(line.score) <= depth;
+                });
+                if(allMates){ break; } // Mate proven within the horizon
+            }
+            if(result.bestMove == bitboard::NULL_MOVE && stopSearch){ // Stopped before an iteration completed: no score, depth 0
+                bitboard::Move list[bitboard::MAX_MOVES];
+                int count = game.position.generateCaptures(list);
+                count += game.position.generateQuiets(list + count);
+                for(int i = 0; i < count && result.bestMove == bitboard::NULL_MOVE; i++){
+                    bitboard::Position next = game.position;
+                    next.makeMove(list[i]);
+                    if(next.wasLegal()){ result.bestMove = list[i]; result.pv = {list[i]}; }
+                }
+            }
+            table->endSearch();
+            result.nodes = nodes;
+            result.seconds = elapsedSeconds();
+            return result;
+        }
+
+        // UCI info lines of the last completed iteration, one per MultiPV line
+        static std::string uciInfo(const SearchResult &result){
+            std::ostringstream out;
+            for(size_t i = 0; i < result.lines.size(); i++){
+                out << "info depth " << result.depth << " multipv " << i + 1
+                    << " score " << scoreToUci(result.lines[i].score)
+                    << " nodes " << result.nodes
+                    << " time " << (uint64_t)(result.seconds * 1000)
+                    << " pv";
+                for(bitboard::Move move : result.lines[i].pv){ out << " " << bitboard::moveToUci(move); }
+                out << "\n";
+            }
+            return out.str();
+        }
+
+        // Context behind the static entry points, searches the process-wide hash table
+        static blindSearch &shared(){
+            static blindSearch instance;
+            return instance;
+        }
+
+        static std::string getBestMove(const GameHistory &game, int searchDepth = MAX_SEARCH_DEPTH){
+            SearchLimits limits;
+            limits.depth = searchDepth;
+            bitboard::Move bestMove = shared().search(game, limits).bestMove;
+            std::cout << "\nBest Move Found: " << bitboard::moveToUci(bestMove) << "\n";
+            return bitboard::moveToUci(bestMove);
+        }
+
+        static std::string getBestMove(const std::string &fenBoard, int searchDepth = MAX_SEARCH_DEPTH){
+            return getBestMove(GameHistory(fenBoard), searchDepth);
+        }
+    
+    };
+
+    // Alternative to blindSearch; keeps its tree between moves of the same game
+    MctsSearch mcts;
+
+    std::string getBestMoveMcts(const GameHistory &game, uint64_t playouts, int threads){
+        bitboard::Move bestMove = mcts.getBestMove(game.position, game.keys, playouts, threads);
+        std::cout << "\nBest Move Found: " << bitboard::moveToUci(bestMove) << "\n";
+        return bitboard::moveToUci(bestMove);
+    }
+
+    int blindSearch::reductions[MAX_PLY][bitboard::MAX_MOVES] = {};
+    
+    std::chrono::time_point<std::chrono::system_clock> timeBegin;
+    std::chrono::time_point<std::chrono::system_clock> timeEnd;
+
+    void initialize(){
+        bitboard::initTables();
+        std::fill(boardState::bestScoresForDepth, boardState::bestScoresForDepth + MAX_SEARCH_DEPTH, INT64_MIN);
+        timeBegin = std::chrono::system_clock::now();
+    }
+
+    void finalize(){
+        timeEnd = std::chrono::system_clock::now();
+        stampTextFile(timeBegin, timeEnd);
+    }
+
+}
@@ -0,0 +1,247 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <map>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bitboard.hpp"
+
+namespace chess
+{
+    enum Bound : uint8_t{
+        BOUND_NONE,
+        BOUND_UPPER,        // Failed low, the score is at most this
+        BOUND_LOWER,        // Failed high, the score is at least this
+        BOUND_EXACT
+    };
+
+    struct TTEntry{
+        uint64_t key = 0;
+        bitboard::Move move = bitboard::NULL_MOVE;
+        int16_t depth = -1;
+        Bound bound = BOUND_NONE;
+        int32_t score = 0;                      // Mates counted from this position, not from the root
+    };
+
+    // Single-slot, always-replace-unless-deeper hash table keyed by zobrist key.
+    // Safe to share between search threads without locks: each slot stores key ^ data
+    // next to data, so a slot torn by two concurrent writers fails the key check.
+    // The slots live on the heap, or in a memory-mapped file that outlives the process.
+    struct TranspositionTable{
+        struct Slot{
+            std::atomic<uint64_t> check{0};     // key ^ data
+            std::atomic<uint64_t> data{0};      // move | depth << 16 | bound << 24 | score << 32
+        };
+
+        // First page of a hash file, the slots follow it
+        struct FileHeader{
+            char magic[8];
+            uint32_t version;
+            uint32_t slotSize;
+            uint64_t slotCount;
+            uint64_t keyScheme;                 // Changes whenever the zobrist keys do
+            uint64_t checksum;                  // Of the slots, written by flush()
+        };
+        static constexpr char FILE_MAGIC[8] = {'E', 'V', 'A', 'L', 'H', 'A', 'S', 'H'};
+        static const uint32_t FILE_VERSION = 2;
+        static const size_t HEADER_BYTES = 4096;
+
+        std::unique_ptr<Slot[]> heapSlots;
+        Slot *slots = nullptr;
+        uint64_t mask = 0;
+        void *mapping = nullptr;
+        size_t mappingBytes = 0;
+        std::string filePath;
+        std::mutex useMutex;                    // Orders searches starting and ending against remapping
+        int searches = 0;                       // Running on the table, it is flushed when the last one ends
+
+        explicit TranspositionTable(size_t sizeMB = 16){ resize(sizeMB); }
+        ~TranspositionTable(){ unmap(); }
+        TranspositionTable(const TranspositionTable&) = delete;
+        TranspositionTable &operator=(const TranspositionTable&) = delete;
+
+        static uint64_t slotCountFor(size_t sizeMB){
+            size_t count = 1;
+            while (count * 2 * sizeof(Slot) <= sizeMB * 1024 * 1024) { count *= 2; }
+            return count;
+        }
+
+        // The table must not be in use, like for mapFile()
+        void resize(size_t sizeMB){
+            unmap();
+            uint64_t count = slotCountFor(sizeMB);
+            heapSlots.reset(new Slot[count]);
+            slots = heapSlots.get();
+            mask = count - 1;
+        }
+
+        void clear(){
+            for (uint64_t i = 0; i <= mask; i++) {
+                slots[i].check.store(0, std::memory_order_relaxed);
+                slots[i].data.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        bool probe(uint64_t key, TTEntry &entry) const{
+            const Slot &slot = slots[key & mask];
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.check.load(std::memory_order_relaxed) ^ data) != key) { return false; }
+            entry.key = key;
+            entry.move = (bitboard::Move)(data & 0xFFFF);
+            entry.depth = (int16_t)((data >> 16) & 0xFF);
+            entry.bound = (Bound)((data >> 24) & 0x3);
+            entry.score = (int32_t)(uint32_t)(data >> 32);
+            return true;
+        }
+
+        void store(uint64_t key, bitboard::Move move, int depth, int64_t score, Bound bound){
+            Slot &slot = slots[key & mask];
+            TTEntry old;
+            if (probe(key, old) && old.depth > depth) { return; }
+            uint64_t data = move | (uint64_t)(uint8_t)depth << 16 | (uint64_t)bound << 24
+                            | (uint64_t)(uint32_t)(int32_t)score << 32;
+            slot.check.store(key ^ data, std::memory_order_relaxed);
+            slot.data.store(data, std::memory_order_relaxed);
+        }
+
+        bool isMapped() const{ return mapping != nullptr; }
+
+        // Every search brackets its use of the table with these
+        void beginSearch(){
+            std::lock_guard<std::mutex> lock(useMutex);
+            searches++;
+        }
+
+        void endSearch(){
+            std::lock_guard<std::mutex> lock(useMutex);
+            if (--searches == 0) { flush(); } // Later writers flush again when they end
+        }
+
+        static uint64_t keyScheme(){
+            bitboard::initTables();     // No-op once the keys exist
+            return bitboard::zobristPieces[0][0] ^ bitboard::zobristSide ^ bitboard::zobristCastling[15];
+        }
+
+        uint64_t checksum() const{
+            uint64_t sum = 0xcbf29ce484222325ULL;
+            for (uint64_t i = 0; i <= mask; i++) {
+                sum = (sum ^ slots[i].check.load(std::memory_order_relaxed)) * 0x100000001b3ULL;
+                sum = (sum ^ slots[i].data.load(std::memory_order_relaxed)) * 0x100000001b3ULL;
+            }
+            return sum;
+        }
+
+        // Backs the table with a file. Earlier contents are kept only if the header matches this
+        // build and the slots match the checksum of the last flush; otherwise the file starts empty.
+        // Returns 1 if entries were reused, 0 if it starts empty, -1 if the file cannot be used or
+        // a search is running on the table (which then stays as it was).
+        int mapFile(const std::string &path, size_t sizeMB){
+            std::lock_guard<std::mutex> lock(useMutex);
+            if (isMapped() && path == filePath) { return 1; } // Next move of the same game
+            if (searches > 0) { return -1; }
+            uint64_t count = slotCountFor(sizeMB);
+            size_t bytes = HEADER_BYTES + count * sizeof(Slot);
+
+            int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0) { return -1; }
+            struct stat info;
+            bool sizeMatches = fstat(fd, &info) == 0 && (size_t)info.st_size == bytes;
+            if (!sizeMatches && ftruncate(fd, bytes) != 0) { close(fd); return -1; }
+            void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (memory == MAP_FAILED) { return -1; }
+
+            unmap();
+            heapSlots.reset();
+            mapping = memory;
+            mappingBytes = bytes;
+            filePath = path;
+            slots = reinterpret_cast<Slot*>((char*)memory + HEADER_BYTES);
+            mask = count - 1;
+
+            FileHeader &header = *reinterpret_cast<FileHeader*>(memory);
+            bool valid = sizeMatches && std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0
+                         && header.version == FILE_VERSION && header.slotSize == sizeof(Slot)
+                         && header.slotCount == count && header.keyScheme == keyScheme()
+                         && header.checksum == checksum();
+            if (valid) { return 1; }
+            clear();
+            std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+            header.version = FILE_VERSION;
+            header.slotSize = sizeof(Slot);
+            header.slotCount = count;
+            header.keyScheme = keyScheme();
+            flush();
+            return 0;
+        }
+
+        // Makes the file consistent on disk, call between searches
+        void flush(){
+            if (!isMapped()) { return; }
+            reinterpret_cast<FileHeader*>(mapping)->checksum = checksum();
+            msync(mapping, mappingBytes, MS_SYNC);
+        }
+
+        void unmap(){
+            if (!isMapped()) { return; }
+            flush();
+            munmap(mapping, mappingBytes);
+            mapping = nullptr;
+            mappingBytes = 0;
+            filePath.clear();
+            slots = nullptr;
+        }
+
+        // Back to an empty heap table of the same size. False while a search is running on it.
+        bool unmapFile(){
+            std::lock_guard<std::mutex> lock(useMutex);
+            if (searches > 0) { return false; }
+            if (!isMapped()) { return true; }
+            size_t sizeMB = (mask + 1) * sizeof(Slot) / (1024 * 1024);
+            resize(std::max<size_t>(sizeMB, 1));
+            return true;
+        }
+    };
+
+    // Hash files opened through the C API. Each game gets its own table; games naming the same
+    // path share one table rather than mapping the file twice. A search holds its table, so a
+    // table replaced or closed while searched is unmapped (and flushed) once that search ends.
+    struct HashFiles{
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<TranspositionTable>> games;
+
+        // Same return values as TranspositionTable::mapFile
+        int open(const std::string &gameId, const std::string &path, size_t sizeMB){
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto &game : games) {
+                if (game.second->filePath == path) {
+                    games[gameId] = game.second;
+                    return 1;
+                }
+            }
+            auto table = std::make_shared<TranspositionTable>(1);
+            int opened = table->mapFile(path, sizeMB);
+            if (opened < 0) { return -1; }
+            games[gameId] = table;
+            return opened;
+        }
+
+        void close(const std::string &gameId){
+            std::lock_guard<std::mutex> lock(mutex);
+            games.erase(gameId);
+        }
+
+        // Null when the game has no file, it then searches the process-wide table
+        std::shared_ptr<TranspositionTable> table(const std::string &gameId){
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = games.find(gameId);
+            return it == games.end() ? nullptr : it->second;
+        }
+    };
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "search.hpp"
+#include "pgn.hpp"
+
+// Universal Chess Interface over stdin/stdout, so GUIs and the match runner can drive the engine
+namespace chess
+{
+    std::mutex uciOutputMutex;
+
+    void uciSend(const std::string &line){
+        std::lock_guard<std::mutex> lock(uciOutputMutex);
+        std::cout << line << std::endl;
+    }
+
+    // Switches that make a build play as a different configuration
+    const std::pair<const char*, bool SelectiveSearch::*> UCI_SELECTIVE_OPTIONS[] = {
+        {"NullMovePruning", &SelectiveSearch::nullMovePruning},
+        {"NullMoveVerification", &SelectiveSearch::nullMoveVerification},
+        {"LateMoveReductions", &SelectiveSearch::lateMoveReductions},
+        {"ReverseFutilityPruning", &SelectiveSearch::reverseFutilityPruning},
+        {"FutilityPruning", &SelectiveSearch::futilityPruning},
+        {"MateDistancePruning", &SelectiveSearch::mateDistancePruning}
+    };
+
+    struct UciSession{
+        GameHistory game{START_FEN};
+        blindSearch search;
+        std::thread searchThread;
+        std::atomic<bool> stop{false};
+        std::mutex stopMutex;
+        std::condition_variable stopped;
+        int multiPv = 1;
+
+        ~UciSession(){ stopSearch(); }
+
+        void waitForSearch(){
+            if(searchThread.joinable()){ searchThread.join(); }
+        }
+
+        void stopSearch(){
+            {
+                std::lock_guard<std::mutex> lock(stopMutex);
+                stop = true;
+            }
+            stopped.notify_all();
+            waitForSearch();
+        }
+
+        void setOption(const std::string &name, const std::string &value){
+            if(name == "Hash"){ tt.resize(std::max(1, std::stoi(value))); return; }
+            if(name == "Clear Hash"){ tt.clear(); return; }
+            if(name == "MultiPV"){ multiPv = std::max(1, std::stoi(value)); return; }
+            if(name == "StagedMoveGeneration"){ MovePicker::staged = value == "true"; return; }
+            for(const auto &option : UCI_SELECTIVE_OPTIONS){
+                if(name == option.first){ selective.*option.second = value == "true"; return; }
+            }
+            uciSend("info string unknown option " + name);
+        }
+
+        void position(std::istringstream &args){
+            std::string token, fen;
+            args >> token;
+            if(token == "startpos"){
+                fen = START_FEN;
+                args >> token;
+            }
+            else if(token == "fen"){
+                while(args >> token && token != "moves"){ fen += (fen.empty() ? "" : " ") + token; }
+            }
+            std::vector<std::string> moves;
+            while(args >> token){ moves.push_back(token); }
+            try{
+                game = GameHistory(fen, moves);
+            }
+            catch(const std::exception &e){
+                uciSend(std::string("info string ") + e.what());
+            }
+        }
+
+        void go(std::istringstream &args){
+            SearchLimits limits;
+            limits.multiPv = multiPv;
+            double clock[2] = {0, 0}, increment[2] = {0, 0};
+            bool timed = false, infinite = false;
+            std::string token;
+            while(args >> token){
+                if(token == "wtime"){ args >> clock[WHITE]; clock[WHITE] /= 1000; timed = true; }
+                else if(token == "btime"){ args >> clock[BLACK]; clock[BLACK] /= 1000; timed = true; }
+                else if(token == "winc"){ args >> increment[WHITE]; increment[WHITE] /= 1000; }
+                else if(token == "binc"){ args >> increment[BLACK]; increment[BLACK] /= 1000; }
+                else if(token == "movetime"){ args >> limits.seconds; limits.seconds /= 1000; limits.depth = MAX_PLY - 1; }
+                else if(token == "depth"){ args >> limits.depth; }
+                else if(token == "nodes"){ args >> limits.nodes; limits.depth = MAX_PLY - 1; }
+                else if(token == "infinite"){ infinite = true; }
+            }
+            int side = game.position.side;
+            if(timed){
+                limits.seconds = moveTime(clock[side], increment[side]);
+                limits.depth = MAX_PLY - 1;
+            }
+            if(infinite){ limits = SearchLimits(); limits.depth = MAX_PLY - 1; limits.multiPv = multiPv; }
+
+            stop = false;
+            search.stopSignal = &stop;
+            searchThread = std::thread([this, limits, infinite](){
+                SearchResult result = search.search(game, limits);
+                if(infinite){ // The protocol only allows bestmove after stop, even once the search is done
+                    std::unique_lock<std::mutex> lock(stopMutex);
+                    stopped.wait(lock, [this]{ return stop.load(); });
+                }
+                std::string info = blindSearch::uciInfo(result);
+                if(!info.empty()){ info.pop_back(); uciSend(info); }
+                uciSend("bestmove " + (result.bestMove == bitboard::NULL_MOVE ? std::string("0000") : bitboard::moveToUci(result.bestMove)));
+            });
+        }
+
+        void run(std::istream &in){
+            for(std::string line; std::getline(in, line); ){
+                std::istringstream args(line);
+                std::string command;
+                args >> command;
+                if(command == "uci"){
+                    uciSend("id name eval_engine");
+                    uciSend("option name Hash type spin default 16 min 1 max 65536");
+                    uciSend("option name Clear Hash type button");
+                    uciSend("option name MultiPV type spin default 1 min 1 max 256");
+                    uciSend("option name StagedMoveGeneration type check default true");
+                    for(const auto &option : UCI_SELECTIVE_OPTIONS){
+                        uciSend(std::string("option name ") + option.first + " type check default true");
+                    }
+                    uciSend("uciok");
+                }
+                else if(command == "isready"){ uciSend("readyok"); }
+                else if(command == "setoption"){
+                    std::string token, name, value;
+                    args >> token; // name
+                    while(args >> token && token != "value"){ name += (name.empty() ? "" : " ") + token; }
+                    std::getline(args >> std::ws, value);
+                    waitForSearch();
+                    setOption(name, value);
+                }
+                else if(command == "ucinewgame"){ waitForSearch(); tt.clear(); }
+                else if(command == "position"){ waitForSearch(); position(args); }
+                else if(command == "go"){ waitForSearch(); go(args); }
+                else if(command == "stop"){ stopSearch(); }
+                else if(command == "quit"){ break; }
+            }
+            stopSearch();
+        }
+    };
+
+    void uciLoop(){
+        bitboard::initTables();
+        UciSession session;
+        session.run(std::cin);
+    }
+}